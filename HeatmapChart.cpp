@@ -0,0 +1,237 @@
+/*
+ *    This is SimpleReportGenerator, a very basic report generator on top of Qt.
+ *    Copyright (C) 2014 - 2015  Volker Knollmann
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include <QTransform>
+
+#include "HeatmapChart.h"
+#include "ImageItem.h"
+
+namespace SimpleReportLib {
+
+  constexpr int HeatmapChart::COLOR_MAP_SIZE;
+
+  //----------------------------------------------------------------------------
+
+  HeatmapChart::HeatmapChart(SimpleReportGenerator* _rep, double _x0, double _y0, double _w, double _h)
+    :LineChart(_rep, _x0, _y0, _w, _h), nRows(0), nCols(0), hasUserValueRange(false), userVMin(0), userVMax(0),
+      invalidValueColor(qRgb(0x80, 0x80, 0x80))
+  {
+    // the default color map is a blue-to-red ramp
+    setColorMap({qRgb(0x3b, 0x4c, 0xc0), qRgb(0xdd, 0xdd, 0xdd), qRgb(0xb4, 0x04, 0x26)});
+  }
+
+  //----------------------------------------------------------------------------
+
+  void HeatmapChart::setMatrix(vector<double>&& values, int _nRows, int _nCols)
+  {
+    if ((_nRows < 1) || (_nCols < 1) || (values.size() != static_cast<size_t>(_nRows) * _nCols))
+    {
+      throw invalid_argument("Invalid matrix dimensions for HeatmapChart!");
+    }
+
+    matrix = std::move(values);
+    nRows = _nRows;
+    nCols = _nCols;
+  }
+
+  //----------------------------------------------------------------------------
+
+  void HeatmapChart::setMatrix(const double* values, int _nRows, int _nCols)
+  {
+    if ((values == nullptr) || (_nRows < 1) || (_nCols < 1))
+    {
+      throw invalid_argument("Invalid matrix for HeatmapChart!");
+    }
+
+    setMatrix(vector<double>(values, values + static_cast<size_t>(_nRows) * _nCols), _nRows, _nCols);
+  }
+
+  //----------------------------------------------------------------------------
+
+  void HeatmapChart::setValueRange(double vMin, double vMax)
+  {
+    if (vMax <= vMin)
+    {
+      throw invalid_argument("Invalid value range for HeatmapChart!");
+    }
+
+    hasUserValueRange = true;
+    userVMin = vMin;
+    userVMax = vMax;
+  }
+
+  //----------------------------------------------------------------------------
+
+  void HeatmapChart::setColorMap(const vector<QRgb>& colors)
+  {
+    if (colors.empty())
+    {
+      throw invalid_argument("Empty color map for HeatmapChart!");
+    }
+
+    // linearly interpolate the provided colors into a lookup table
+    colorMap.resize(COLOR_MAP_SIZE);
+    for (int i = 0; i < COLOR_MAP_SIZE; ++i)
+    {
+      const double pos = (colors.size() - 1) * static_cast<double>(i) / (COLOR_MAP_SIZE - 1);
+      const size_t idx0 = static_cast<size_t>(pos);
+      const size_t idx1 = min(idx0 + 1, colors.size() - 1);
+      const double frac = pos - idx0;
+
+      auto mix = [frac](int c0, int c1) {
+        return static_cast<int>(lround(c0 + (c1 - c0) * frac));
+      };
+      colorMap[i] = qRgb(
+                      mix(qRed(colors[idx0]), qRed(colors[idx1])),
+                      mix(qGreen(colors[idx0]), qGreen(colors[idx1])),
+                      mix(qBlue(colors[idx0]), qBlue(colors[idx1]))
+                      );
+    }
+  }
+
+  //----------------------------------------------------------------------------
+
+  QImage HeatmapChart::toImage() const
+  {
+    if (!(hasData())) return QImage{};
+
+    double vMin = userVMin;
+    double vMax = userVMax;
+    if (!hasUserValueRange) tie(vMin, vMax) = calcFiniteMinMax(matrix);
+    const float scale = (vMax > vMin) ? static_cast<float>((COLOR_MAP_SIZE - 1) / (vMax - vMin)) : 0.0f;
+    const float offset = static_cast<float>(vMin);
+
+    // the color map plus one extra entry for non-finite values
+    vector<QRgb> lutData{colorMap};
+    lutData.push_back(invalidValueColor);
+    const QRgb* lut = lutData.data();
+
+    QImage img{nCols, nRows, QImage::Format_RGB32};
+    vector<int> idx(nCols);
+    for (int r = 0; r < nRows; ++r)
+    {
+      // the first pass only does arithmetic and clamping and is
+      // vectorized by the compiler; the second pass is the table lookup.
+      // The clamping is written so that NaN ends up as 0, because
+      // all comparisons with NaN are false
+      const double* rowData = matrix.data() + static_cast<size_t>(r) * nCols;
+      for (int c = 0; c < nCols; ++c)
+      {
+        float f = (static_cast<float>(rowData[c]) - offset) * scale;
+        f = (f >= 0.0f) ? f : 0.0f;
+        f = (f <= (COLOR_MAP_SIZE - 1)) ? f : (COLOR_MAP_SIZE - 1);
+        int i = static_cast<int>(f);
+        i = (i < 0) ? 0 : ((i > (COLOR_MAP_SIZE - 1)) ? (COLOR_MAP_SIZE - 1) : i);
+        idx[c] = std::isfinite(rowData[c]) ? i : COLOR_MAP_SIZE;
+      }
+
+      // row 0 is at the bottom of the image
+      QRgb* line = reinterpret_cast<QRgb*>(img.scanLine(nRows - 1 - r));
+      for (int c = 0; c < nCols; ++c) line[c] = lut[idx[c]];
+    }
+
+    return img;
+  }
+
+  //----------------------------------------------------------------------------
+
+  void HeatmapChart::setInvalidValueColor(QRgb color)
+  {
+    invalidValueColor = color;
+  }
+
+  //----------------------------------------------------------------------------
+
+  tuple<double, double> HeatmapChart::calcFiniteMinMax(const vector<double>& values)
+  {
+    // NaN and +/-inf are skipped; they have their own color
+    double minVal = 0.0;
+    double maxVal = 0.0;
+    bool isFirst = true;
+    for (double v : values)
+    {
+      if (!(std::isfinite(v))) continue;
+
+      if (isFirst)
+      {
+        minVal = v;
+        maxVal = v;
+        isFirst = false;
+        continue;
+      }
+      if (v < minVal) minVal = v;
+      if (v > maxVal) maxVal = v;
+    }
+
+    return make_tuple(minVal, maxVal);
+  }
+
+  //----------------------------------------------------------------------------
+
+  tuple<double, double, double, double> HeatmapChart::get_XMin_XMax_YMin_YMax() const
+  {
+    if (!(hasData())) return make_tuple(0.0, 1.0, 0.0, 1.0);
+
+    return make_tuple(0.0, static_cast<double>(nCols), 0.0, static_cast<double>(nRows));
+  }
+
+  //----------------------------------------------------------------------------
+
+  bool HeatmapChart::hasData() const
+  {
+    return !(matrix.empty());
+  }
+
+  //----------------------------------------------------------------------------
+
+  void HeatmapChart::renderData(double xmin, double xmax, double ymin, double ymax)
+  {
+    // only complete cells inside the window are shown
+    const int c0 = max(0, static_cast<int>(ceil(xmin)));
+    const int c1 = min(nCols, static_cast<int>(floor(xmax)));
+    const int r0 = max(0, static_cast<int>(ceil(ymin)));
+    const int r1 = min(nRows, static_cast<int>(floor(ymax)));
+    if ((c1 <= c0) || (r1 <= r0)) return;
+
+    QImage img = toImage();
+    if ((c0 > 0) || (c1 < nCols) || (r0 > 0) || (r1 < nRows))
+    {
+      // image rows are flipped with respect to the matrix rows
+      img = img.copy(c0, nRows - r1, c1 - c0, r1 - r0);
+    }
+
+    // place the image at the top left corner of the visible
+    // cells and scale it from "pixels" to internal units
+    QRectF plotRect = getPlotRect__internalUnits();
+    const double facX = plotRect.width() / (xmax - xmin);
+    const double facY = plotRect.height() / (ymax - ymin);
+    // QPixmaps may only be created on the GUI thread, but charts
+    // are also laid out on worker threads; so we keep the QImage
+    auto item = make_unique<ImageItem>(img);
+    item->setTransform(QTransform::fromScale(facX, facY));
+    item->setPos(plotRect.left() + (c0 - xmin) * facX, plotRect.bottom() - (r1 - ymin) * facY);
+    rep->addGraphicsItem(std::move(item));
+  }
+
+  //----------------------------------------------------------------------------
+
+}
@@ -0,0 +1,88 @@
+/*
+ *    This is SimpleReportGenerator, a very basic report generator on top of Qt.
+ *    Copyright (C) 2014 - 2015  Volker Knollmann
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HEATMAPCHART_H
+#define HEATMAPCHART_H
+
+#include <vector>
+
+#include <QImage>
+#include <QRgb>
+
+#include "LineChart.h"
+
+namespace SimpleReportLib {
+
+  /** \brief A chart that shows a dense matrix of values as colored cells
+   *
+   * The matrix is converted into a QImage with one pixel per cell and the image
+   * is placed as a single image item that is scaled to the plot area. NaN and
+   * infinite values are ignored for the automatic value range and shown in a
+   * separate color.
+   *
+   * In value space, column `c` covers x = [c, c+1] and row `r` covers y = [r, r+1];
+   * thus row 0 is shown at the bottom of the plot, just like in a LineChart.
+   * Axes and labels are inherited from the LineChart.
+   */
+  class HeatmapChart : public LineChart
+  {
+  public:
+    static constexpr int COLOR_MAP_SIZE = 256;
+
+    HeatmapChart(SimpleReportGenerator* _rep, double _x0, double _y0, double _w, double _h);
+
+    /** \brief Moves a row-major matrix with `_nRows` x `_nCols` values into the chart */
+    void setMatrix(vector<double>&& values, int _nRows, int _nCols);
+
+    /** \brief Copies a row-major matrix with `_nRows` x `_nCols` values into the chart */
+    void setMatrix(const double* values, int _nRows, int _nCols);
+
+    /** \brief Sets the values that are mapped to the first and the last color
+     * of the color map; by default, the min and max of the matrix are used
+     */
+    void setValueRange(double vMin, double vMax);
+
+    /** \brief Replaces the default color map; the map is resampled to COLOR_MAP_SIZE entries */
+    void setColorMap(const vector<QRgb>& colors);
+
+    /** \brief Sets the color for NaN and infinite values; gray by default */
+    void setInvalidValueColor(QRgb color);
+
+    /** \returns the matrix as an image with one pixel per cell (row 0 at the bottom) */
+    QImage toImage() const;
+
+    virtual tuple<double, double, double, double> get_XMin_XMax_YMin_YMax() const override;
+    virtual bool hasData() const override;
+
+  protected:
+    virtual void renderData(double xmin, double xmax, double ymin, double ymax) override;
+    static tuple<double, double> calcFiniteMinMax(const vector<double>& values);
+
+    vector<double> matrix;
+    int nRows;
+    int nCols;
+    bool hasUserValueRange;
+    double userVMin;
+    double userVMax;
+    vector<QRgb> colorMap;
+    QRgb invalidValueColor;
+  };
+
+}
+
+#endif // HEATMAPCHART_H
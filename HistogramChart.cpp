@@ -0,0 +1,186 @@
+/*
+ *    This is SimpleReportGenerator, a very basic report generator on top of Qt.
+ *    Copyright (C) 2014 - 2015  Volker Knollmann
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+
+#include <QGraphicsPathItem>
+#include <QPainterPath>
+
+#include "HistogramChart.h"
+
+namespace SimpleReportLib {
+
+  constexpr size_t HistogramChart::MIN_SAMPLES_PER_THREAD;
+
+  //----------------------------------------------------------------------------
+
+  HistogramChart::HistogramChart(SimpleReportGenerator* _rep, double _x0, double _y0, double _w, double _h, double _binMin, double _binMax, int _nBins)
+    :LineChart(_rep, _x0, _y0, _w, _h), binMin(_binMin), binMax(_binMax), nBins(_nBins), outOfRangeCount(0)
+  {
+    if ((nBins < 1) || (binMax <= binMin))
+    {
+      throw invalid_argument("Invalid bin definition for HistogramChart ctor!");
+    }
+
+    binCounts.assign(nBins, 0);
+  }
+
+  //----------------------------------------------------------------------------
+
+  void HistogramChart::addSamples(const double* samples, size_t n)
+  {
+    if ((samples == nullptr) || (n == 0)) return;
+
+    // determine the number of worker threads
+    size_t nThreads = max<size_t>(1, thread::hardware_concurrency());
+    nThreads = min(nThreads, n / MIN_SAMPLES_PER_THREAD);
+
+    if (nThreads < 2)
+    {
+      outOfRangeCount += binChunk(samples, n, binCounts);
+      return;
+    }
+
+    // each thread bins its own chunk into its own partial
+    // histogram, so there's no shared state between the threads
+    vector<vector<size_t>> partialCounts(nThreads, vector<size_t>(nBins, 0));
+    vector<size_t> partialOutOfRange(nThreads, 0);
+    vector<thread> workers;
+    workers.reserve(nThreads);
+    const size_t chunkSize = (n + nThreads - 1) / nThreads;
+    for (size_t t = 0; t < nThreads; ++t)
+    {
+      const size_t start = t * chunkSize;
+      const size_t len = min(chunkSize, n - start);
+      auto job = [this, samples, start, len, t, &partialCounts, &partialOutOfRange]() {
+        partialOutOfRange[t] = binChunk(samples + start, len, partialCounts[t]);
+      };
+
+      // if no more threads can be started, the remaining
+      // chunks are binned on the calling thread
+      try
+      {
+        workers.emplace_back(job);
+      }
+      catch (std::system_error&)
+      {
+        job();
+      }
+    }
+
+    // wait for all threads and merge the partial histograms
+    for (thread& worker : workers) worker.join();
+    for (size_t t = 0; t < nThreads; ++t)
+    {
+      const vector<size_t>& partial = partialCounts[t];
+      for (int i = 0; i < nBins; ++i) binCounts[i] += partial[i];
+      outOfRangeCount += partialOutOfRange[t];
+    }
+  }
+
+  //----------------------------------------------------------------------------
+
+  void HistogramChart::addSamples(const vector<double>& samples)
+  {
+    addSamples(samples.data(), samples.size());
+  }
+
+  //----------------------------------------------------------------------------
+
+  tuple<double, double, double, double> HistogramChart::get_XMin_XMax_YMin_YMax() const
+  {
+    size_t maxCount = *(max_element(binCounts.begin(), binCounts.end()));
+    if (maxCount == 0) maxCount = 1;
+
+    return make_tuple(binMin, binMax, 0.0, static_cast<double>(maxCount));
+  }
+
+  //----------------------------------------------------------------------------
+
+  bool HistogramChart::hasData() const
+  {
+    return any_of(binCounts.begin(), binCounts.end(), [](size_t cnt) { return cnt > 0; });
+  }
+
+  //----------------------------------------------------------------------------
+
+  void HistogramChart::renderData(double xmin, double xmax, double ymin, double ymax)
+  {
+    QRectF plotRect = getPlotRect__internalUnits();
+    const double facX = plotRect.width() / (xmax - xmin);
+    const double facY = plotRect.height() / (ymax - ymin);
+    const double binWidth = (binMax - binMin) / nBins;
+
+    // collect all bars, clipped to the plot window, in a single path
+    QPainterPath path;
+    for (int i = 0; i < nBins; ++i)
+    {
+      if (binCounts[i] == 0) continue;
+
+      double left = max(xmin, binMin + i * binWidth);
+      double right = min(xmax, binMin + (i + 1) * binWidth);
+      double bottom = max(ymin, 0.0);
+      double top = min(ymax, static_cast<double>(binCounts[i]));
+      if ((right <= left) || (top <= bottom)) continue;
+
+      path.addRect(QRectF{
+                     plotRect.left() + (left - xmin) * facX,
+                     plotRect.bottom() - (top - ymin) * facY,
+                     (right - left) * facX,
+                     (top - bottom) * facY
+                   });
+    }
+
+    auto item = make_unique<QGraphicsPathItem>(path);
+    item->setPen(rep->lineType2Pen(LINE_TYPE::THIN));
+    item->setBrush(QBrush(Qt::lightGray));
+    rep->addGraphicsItem(std::move(item));
+  }
+
+  //----------------------------------------------------------------------------
+
+  size_t HistogramChart::binChunk(const double* samples, size_t n, vector<size_t>& counts) const
+  {
+    const double fac = nBins / (binMax - binMin);
+    size_t outOfRange = 0;
+    for (size_t i = 0; i < n; ++i)
+    {
+      const double v = samples[i];
+
+      // this also catches NaNs
+      if (!((v >= binMin) && (v <= binMax)))
+      {
+        ++outOfRange;
+        continue;
+      }
+
+      // "binMax" itself belongs to the last bin
+      int idx = static_cast<int>((v - binMin) * fac);
+      if (idx >= nBins) idx = nBins - 1;
+      ++counts[idx];
+    }
+
+    return outOfRange;
+  }
+
+  //----------------------------------------------------------------------------
+
+}
@@ -0,0 +1,88 @@
+/*
+ *    This is SimpleReportGenerator, a very basic report generator on top of Qt.
+ *    Copyright (C) 2014 - 2015  Volker Knollmann
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HISTOGRAMCHART_H
+#define HISTOGRAMCHART_H
+
+#include <vector>
+
+#include "LineChart.h"
+
+namespace SimpleReportLib {
+
+  /** \brief A chart that bins raw samples into equally sized bins and shows the bins as bars
+   *
+   * The samples are binned immediately when they're added and are not stored. Large
+   * sample sets are binned in parallel; each thread fills its own partial histogram
+   * and the partial histograms are merged afterwards.
+   *
+   * Axes and labels are inherited from the LineChart. All bars are rendered
+   * as a single path item.
+   */
+  class HistogramChart : public LineChart
+  {
+  public:
+    /** \brief sample sets smaller than this are binned by the calling thread only */
+    static constexpr size_t MIN_SAMPLES_PER_THREAD = 100000;
+
+    HistogramChart(
+        SimpleReportGenerator* _rep,   ///< the report to draw into
+        double _x0,   ///< left edge of the plot area in mm
+        double _y0,   ///< top edge of the plot area in mm
+        double _w,   ///< width of the plot area in mm
+        double _h,   ///< height of the plot area in mm
+        double _binMin,   ///< the lower boundary of the first bin
+        double _binMax,   ///< the upper boundary of the last bin
+        int _nBins   ///< the number of bins
+        );
+
+    /** \brief Bins a set of samples and adds them to the current bin counts
+     *
+     * Samples outside of [binMin, binMax] and NaNs are counted as "out of range".
+     */
+    void addSamples(
+        const double* samples,   ///< pointer to the first sample
+        size_t n   ///< number of samples
+        );
+    void addSamples(const vector<double>& samples);
+
+    inline const vector<size_t>& getBinCounts() const { return binCounts; }
+    inline size_t getOutOfRangeCount() const { return outOfRangeCount; }
+
+    virtual tuple<double, double, double, double> get_XMin_XMax_YMin_YMax() const override;
+    virtual bool hasData() const override;
+
+  protected:
+    virtual void renderData(double xmin, double xmax, double ymin, double ymax) override;
+
+    /** \brief Bins a chunk of samples into a (partial) histogram
+     *
+     * \returns the number of samples that were out of range
+     */
+    size_t binChunk(const double* samples, size_t n, vector<size_t>& counts) const;
+
+    double binMin;
+    double binMax;
+    int nBins;
+    vector<size_t> binCounts;
+    size_t outOfRangeCount;
+  };
+
+}
+
+#endif // HISTOGRAMCHART_H
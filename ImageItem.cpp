@@ -0,0 +1,53 @@
+/*
+ *    This is SimpleReportGenerator, a very basic report generator on top of Qt.
+ *    Copyright (C) 2014 - 2015  Volker Knollmann
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QPainter>
+
+#include "ImageItem.h"
+
+namespace SimpleReportLib {
+
+  ImageItem::ImageItem(const QImage& _img)
+    :QGraphicsItem(), img(_img)
+  {
+  }
+
+  //----------------------------------------------------------------------------
+
+  QRectF ImageItem::boundingRect() const
+  {
+    return QRectF{0, 0, static_cast<double>(img.width()), static_cast<double>(img.height())};
+  }
+
+  //----------------------------------------------------------------------------
+
+  void ImageItem::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget)
+  {
+    Q_UNUSED(option);
+    Q_UNUSED(widget);
+
+    // each pixel is a sharp-edged cell, so no smoothing
+    painter->save();
+    painter->setRenderHint(QPainter::SmoothPixmapTransform, false);
+    painter->drawImage(boundingRect(), img);
+    painter->restore();
+  }
+
+  //----------------------------------------------------------------------------
+
+}
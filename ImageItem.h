@@ -0,0 +1,50 @@
+/*
+ *    This is SimpleReportGenerator, a very basic report generator on top of Qt.
+ *    Copyright (C) 2014 - 2015  Volker Knollmann
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef IMAGEITEM_H
+#define IMAGEITEM_H
+
+#include <QGraphicsItem>
+#include <QImage>
+
+namespace SimpleReportLib {
+
+  /** \brief A graphics item that draws a QImage
+   *
+   * In contrast to QGraphicsPixmapItem, the item can be created on any thread
+   * because it doesn't need a QPixmap. The image is drawn 1:1 in item
+   * coordinates (one pixel per unit) without smoothing; use the item's
+   * transformation for scaling.
+   */
+  class ImageItem : public QGraphicsItem
+  {
+  public:
+    ImageItem(const QImage& _img);
+
+    virtual QRectF boundingRect() const override;
+    virtual void paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget) override;
+
+    inline const QImage& getImage() const { return img; }
+
+  protected:
+    QImage img;
+  };
+
+}
+
+#endif // IMAGEITEM_H
@@ -0,0 +1,380 @@
+/*
+ *    This is SimpleReportGenerator, a very basic report generator on top of Qt.
+ *    Copyright (C) 2014 - 2015  Volker Knollmann
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdexcept>
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonParseError>
+
+#include "JsonReportBuilder.h"
+#include "TableWriter.h"
+#include "LineChart.h"
+#include "ScatterChart.h"
+
+namespace SimpleReportLib {
+
+  JsonReportBuilder::JsonReportBuilder(const QJsonObject& _description, const QString& _baseDir)
+    :description(_description), baseDir(_baseDir)
+  {
+  }
+
+  //----------------------------------------------------------------------------
+
+  unique_ptr<JsonReportBuilder> JsonReportBuilder::fromFile(const QString& fileName, QString* errMsg)
+  {
+    QFile f{fileName};
+    if (!(f.open(QIODevice::ReadOnly)))
+    {
+      if (errMsg != nullptr) *errMsg = "Can't open " + fileName;
+      return nullptr;
+    }
+
+    QJsonParseError parseError;
+    QJsonDocument doc = QJsonDocument::fromJson(f.readAll(), &parseError);
+    if (parseError.error != QJsonParseError::NoError)
+    {
+      if (errMsg != nullptr) *errMsg = QString("%1, offset %2: %3").arg(fileName).arg(parseError.offset).arg(parseError.errorString());
+      return nullptr;
+    }
+    if (!(doc.isObject()))
+    {
+      if (errMsg != nullptr) *errMsg = fileName + " doesn't contain a JSON object";
+      return nullptr;
+    }
+
+    return make_unique<JsonReportBuilder>(doc.object(), QFileInfo{fileName}.absolutePath());
+  }
+
+  //----------------------------------------------------------------------------
+
+  unique_ptr<SimpleReportGenerator> JsonReportBuilder::createReport() const
+  {
+    QJsonObject page = description.value("page").toObject();
+    auto report = make_unique<SimpleReportGenerator>(
+                    page.value("width").toDouble(210.0),
+                    page.value("height").toDouble(297.0),
+                    page.value("margin").toDouble(20.0));
+
+    createStyles(*report, description.value("styles").toObject());
+
+    QStringList hdr = toStringList(description.value("header").toArray());
+    QStringList ftr = toStringList(description.value("footer").toArray());
+    while (hdr.size() < 3) hdr.append(QString());
+    while (ftr.size() < 3) ftr.append(QString());
+    report->setGlobalHeader(hdr[0], hdr[1], hdr[2]);
+    report->setGlobalFooter(ftr[0], ftr[1], ftr[2]);
+
+    report->startNextPage();
+    for (const QJsonValue& v : description.value("content").toArray())
+    {
+      layoutItem(*report, v.toObject());
+    }
+
+    report->applyHeaderAndFooterOnAllPages();
+
+    return report;
+  }
+
+  //----------------------------------------------------------------------------
+
+  void JsonReportBuilder::createStyles(SimpleReportGenerator& report, const QJsonObject& styles)
+  {
+    // parents have to be created before their children, but
+    // JSON objects are sorted alphabetically; so we repeat until
+    // no more styles can be created
+    QStringList pending = styles.keys();
+    bool hasProgress = true;
+    while (!(pending.isEmpty()) && hasProgress)
+    {
+      hasProgress = false;
+      for (const QString& name : QStringList{pending})
+      {
+        QJsonObject def = styles.value(name).toObject();
+        QString parentName = def.value("parent").toString();
+        if (!(parentName.isEmpty()) && (report.getTextStyle(parentName) == nullptr)) continue;
+
+        // existing styles (e.g., "H1") are modified instead of re-created
+        TextStyle* style = report.getTextStyle(name);
+        if (style == nullptr) style = report.createChildTextStyle(name, parentName);
+        if (style == nullptr) continue;
+
+        if (def.contains("font")) style->setFontname(def.value("font").toString());
+        if (def.contains("size")) style->setFontSize_MM(def.value("size").toDouble());
+        if (def.contains("bold")) style->setBoldState(def.value("bold").toBool());
+        if (def.contains("italics")) style->setItalicsState(def.value("italics").toBool());
+        if (def.contains("color")) style->setFontColor(QColor{def.value("color").toString()});
+
+        pending.removeAll(name);
+        hasProgress = true;
+      }
+    }
+
+    if (!(pending.isEmpty()))
+    {
+      throw std::invalid_argument("Invalid parent styles for: " + pending.join(", ").toStdString());
+    }
+  }
+
+  //----------------------------------------------------------------------------
+
+  void JsonReportBuilder::layoutItem(SimpleReportGenerator& report, const QJsonObject& item) const
+  {
+    const QString type = item.value("type").toString();
+    const double skipBefore = item.value("skipBefore").toDouble(0.0);
+    const double skipAfter = item.value("skipAfter").toDouble(0.0);
+
+    if (type == "text")
+    {
+      const QString styleName = item.value("style").toString();
+      const QStringList lines = item.value("text").toString().split('\n');
+      for (int i = 0; i < lines.size(); ++i)
+      {
+        report.writeLine(lines[i], styleName, (i == (lines.size() - 1)) ? skipAfter : 0.0, (i == 0) ? skipBefore : 0.0);
+      }
+      return;
+    }
+
+    if (type == "skip")
+    {
+      report.skip(item.value("mm").toDouble(0.0));
+      return;
+    }
+
+    if (type == "line")
+    {
+      report.addHorLine(toLineType(item.value("width").toString("medium")), skipAfter, skipBefore);
+      return;
+    }
+
+    if (type == "pageBreak")
+    {
+      report.startNextPage();
+      return;
+    }
+
+    if (type == "table")
+    {
+      layoutTable(report, item);
+      return;
+    }
+
+    if (type == "chart")
+    {
+      report.skip(skipBefore);
+      layoutChart(report, item);
+      report.skip(skipAfter);
+      return;
+    }
+
+    if (type == "svg")
+    {
+      report.skip(skipBefore);
+      layoutSvg(report, item);
+      report.skip(skipAfter);
+      return;
+    }
+
+    throw std::invalid_argument("Invalid content type: " + type.toStdString());
+  }
+
+  //----------------------------------------------------------------------------
+
+  void JsonReportBuilder::layoutTable(SimpleReportGenerator& report, const QJsonObject& item) const
+  {
+    TabSet tabs = toTabSet(item.value("tabs").toArray());
+    TableWriter tw{tabs};
+    tw.setHeader(toStringList(item.value("header").toArray()));
+    for (const QJsonValue& row : item.value("rows").toArray())
+    {
+      tw.appendRow(toStringList(row.toArray()));
+    }
+    if (item.contains("continuationCaption"))
+    {
+      tw.setNextPageContinuationCaption(item.value("continuationCaption").toString());
+    }
+
+    tw.write(&report);
+  }
+
+  //----------------------------------------------------------------------------
+
+  void JsonReportBuilder::layoutChart(SimpleReportGenerator& report, const QJsonObject& item) const
+  {
+    const double chartHeight = item.value("height").toDouble(60.0);
+    const double chartWidth = item.value("width").toDouble(report.getUsablePageWidth());
+    if (report.getRemainingPageHeight() < chartHeight) report.startNextPage();
+
+    QPointF pos = report.getAbsCursorPos();
+    unique_ptr<LineChart> chart;
+    const QString kind = item.value("kind").toString("line");
+    if (kind == "line")
+    {
+      chart = make_unique<LineChart>(&report, pos.x(), pos.y(), chartWidth, chartHeight);
+    } else if (kind == "scatter") {
+      auto sc = make_unique<ScatterChart>(&report, pos.x(), pos.y(), chartWidth, chartHeight);
+      if (item.contains("markerSize")) sc->setMarkerSize(item.value("markerSize").toDouble());
+      chart = std::move(sc);
+    } else {
+      throw std::invalid_argument("Invalid chart kind: " + kind.toStdString());
+    }
+
+    for (const QJsonValue& v : item.value("traces").toArray())
+    {
+      QJsonArray xArr = v.toObject().value("x").toArray();
+      QJsonArray yArr = v.toObject().value("y").toArray();
+      if (xArr.size() != yArr.size())
+      {
+        throw std::invalid_argument("Chart trace with different numbers of x- and y-values");
+      }
+
+      vector<double> x;
+      vector<double> y;
+      x.reserve(xArr.size());
+      y.reserve(yArr.size());
+      for (const QJsonValue& val : xArr) x.push_back(val.toDouble());
+      for (const QJsonValue& val : yArr) y.push_back(val.toDouble());
+      chart->addTrace(std::move(x), std::move(y));
+    }
+
+    for (const QJsonValue& v : item.value("xLabels").toArray())
+    {
+      chart->addLabel_X(v.toArray().at(0).toDouble(), v.toArray().at(1).toString());
+    }
+    for (const QJsonValue& v : item.value("yLabels").toArray())
+    {
+      chart->addLabel_Y(v.toArray().at(0).toDouble(), v.toArray().at(1).toString());
+    }
+
+    QJsonArray range = item.value("range").toArray();
+    if (item.contains("range") && (range.size() != 4))
+    {
+      throw std::invalid_argument("Invalid chart range");
+    }
+    if (range.size() == 4)
+    {
+      if ((range.at(1).toDouble() <= range.at(0).toDouble()) || (range.at(3).toDouble() <= range.at(2).toDouble()))
+      {
+        throw std::invalid_argument("Invalid chart range");
+      }
+      chart->render(range.at(0).toDouble(), range.at(1).toDouble(), range.at(2).toDouble(), range.at(3).toDouble());
+    } else if (chart->hasData()) {
+      chart->render();
+    }
+
+    report.skip(chartHeight);
+  }
+
+  //----------------------------------------------------------------------------
+
+  void JsonReportBuilder::layoutSvg(SimpleReportGenerator& report, const QJsonObject& item) const
+  {
+    QString fileName = item.value("file").toString();
+    QFile f{QDir{baseDir}.absoluteFilePath(fileName)};
+    if (!(f.open(QIODevice::ReadOnly)))
+    {
+      throw std::invalid_argument("Can't open SVG file " + fileName.toStdString());
+    }
+
+    try
+    {
+      writeSvg(report, f.readAll().toStdString(), item.value("width").toDouble(0.0), item.value("align").toString("left"));
+    }
+    catch (std::invalid_argument&)
+    {
+      throw std::invalid_argument("Invalid SVG data in " + fileName.toStdString());
+    }
+  }
+
+  //----------------------------------------------------------------------------
+
+  void JsonReportBuilder::writeSvg(SimpleReportGenerator& report, const std::string& svgData, double width, const QString& align)
+  {
+    // the SVG's height isn't known before inserting it; so we
+    // only make sure that there's some space left on the page
+    if (!(report.hasSpaceForAnotherLine(QString()))) report.startNextPage();
+
+    QPointF pos = report.getAbsCursorPos();
+    RECT_CORNER corner = RECT_CORNER::TOP_LEFT;
+    if (align == "center")
+    {
+      pos.setX(report.getPageWidth() / 2.0);
+      corner = RECT_CORNER::TOP_CENTER;
+    }
+    if (align == "right")
+    {
+      pos.setX(report.getPageWidth() - pos.x());
+      corner = RECT_CORNER::TOP_RIGHT;
+    }
+
+    QRectF bb = report.addSVG_byData_setW(pos, corner, svgData, width);
+    if (bb.isEmpty())
+    {
+      throw std::invalid_argument("Invalid SVG data");
+    }
+
+    report.skip(bb.height());
+  }
+
+  //----------------------------------------------------------------------------
+
+  QStringList JsonReportBuilder::toStringList(const QJsonArray& arr)
+  {
+    // numbers in tables are common, so we accept
+    // them as well and convert them to text
+    QStringList result;
+    for (const QJsonValue& v : arr)
+    {
+      result.append(v.isDouble() ? QString::number(v.toDouble()) : v.toString());
+    }
+
+    return result;
+  }
+
+  //----------------------------------------------------------------------------
+
+  TabSet JsonReportBuilder::toTabSet(const QJsonArray& arr)
+  {
+    TabSet tabs;
+    for (const QJsonValue& v : arr)
+    {
+      QJsonObject tab = v.toObject();
+      const QString align = tab.value("align").toString("left");
+      TAB_JUSTIFICATION just = TAB_LEFT;
+      if (align == "center") just = TAB_CENTER;
+      if (align == "right") just = TAB_RIGHT;
+      tabs.addTab(tab.value("pos").toDouble(), just);
+    }
+
+    return tabs;
+  }
+
+  //----------------------------------------------------------------------------
+
+  LINE_TYPE JsonReportBuilder::toLineType(const QString& width)
+  {
+    if (width == "thin") return THIN;
+    if (width == "thick") return THICK;
+    return MED;
+  }
+
+  //----------------------------------------------------------------------------
+
+}
@@ -0,0 +1,122 @@
+/*
+ *    This is SimpleReportGenerator, a very basic report generator on top of Qt.
+ *    Copyright (C) 2014 - 2015  Volker Knollmann
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef JSONREPORTBUILDER_H
+#define JSONREPORTBUILDER_H
+
+#include <memory>
+
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QString>
+
+#include "SimpleReportGenerator.h"
+#include "TabSet.h"
+
+namespace SimpleReportLib {
+
+  /** \brief Lays out a report from a declarative JSON description
+   *
+   * The description is an object with the following (optional) members:
+   *
+   *   "page":    {"width": 210, "height": 297, "margin": 20}   (mm; A4 by default)
+   *   "styles":  {"Name": {"parent": "", "font": "Arial", "size": 4, "bold": true, "italics": false, "color": "#000080"}, ...}
+   *   "header":  ["left", "center", "right"]   (may contain the page number tokens, see HeaderFooterStrings)
+   *   "footer":  ["left", "center", "right"]
+   *   "content": [item, ...]
+   *
+   * The content items are laid out from top to bottom; new pages are started as needed:
+   *
+   *   {"type": "text", "text": "...", "style": "H1", "skipBefore": 0, "skipAfter": 0}   ("\n" starts a new line)
+   *   {"type": "skip", "mm": 5}
+   *   {"type": "line", "width": "thin" | "medium" | "thick", "skipBefore": 0, "skipAfter": 0}
+   *   {"type": "pageBreak"}
+   *   {"type": "table", "tabs": [{"pos": 40, "align": "left" | "center" | "right"}, ...],
+   *                     "header": ["...", ...], "rows": [["...", ...], ...], "continuationCaption": "..."}
+   *   {"type": "chart", "kind": "line" | "scatter", "height": 60, "traces": [{"x": [...], "y": [...]}, ...],
+   *                     "xLabels": [[x, "..."], ...], "yLabels": [[y, "..."], ...], "range": [xmin, xmax, ymin, ymax]}
+   *   {"type": "svg", "file": "logo.svg", "width": 40, "align": "left" | "center" | "right"}
+   *
+   * Relative file names are resolved against a base directory, usually
+   * the directory of the description file.
+   */
+  class JsonReportBuilder
+  {
+  public:
+    JsonReportBuilder(
+        const QJsonObject& _description,   ///< the report description
+        const QString& _baseDir = QString()   ///< the directory for relative file names
+        );
+
+    /** \brief Reads a description from a file
+     *
+     * \returns nullptr if the file can't be read or doesn't contain a JSON object
+     */
+    static std::unique_ptr<JsonReportBuilder> fromFile(
+        const QString& fileName,   ///< the name of the JSON file
+        QString* errMsg = nullptr   ///< receives a description of the problem, if any
+        );
+
+    /** \brief Creates a new report and lays out the complete description
+     *
+     * Throws std::invalid_argument if the description contains invalid items.
+     */
+    std::unique_ptr<SimpleReportGenerator> createReport() const;
+
+    inline const QJsonObject& getDescription() const { return description; }
+    inline const QString& getBaseDir() const { return baseDir; }
+
+    /** \brief Creates or modifies the text styles of a report according to a "styles" object
+     *
+     * Throws std::invalid_argument if a style refers to a parent that doesn't exist.
+     */
+    static void createStyles(SimpleReportGenerator& report, const QJsonObject& styles);
+
+    /** \returns the array's values as strings; numbers are converted to text */
+    static QStringList toStringList(const QJsonArray& arr);
+
+    /** \returns the tab set for an array of tab definitions like [{"pos": 40, "align": "right"}, ...] */
+    static TabSet toTabSet(const QJsonArray& arr);
+
+    /** \returns the line type for "thin", "medium" or "thick"; MED for all other values */
+    static LINE_TYPE toLineType(const QString& width);
+
+    /** \brief Inserts an SVG image at the cursor position and moves the cursor below the image
+     *
+     * Throws std::invalid_argument if the SVG data is invalid.
+     */
+    static void writeSvg(
+        SimpleReportGenerator& report,   ///< the report to write to
+        const std::string& svgData,   ///< the SVG image
+        double width,   ///< the width of the image in mm; 0 = natural size
+        const QString& align   ///< "left", "center" or "right"
+        );
+
+  protected:
+    void layoutItem(SimpleReportGenerator& report, const QJsonObject& item) const;
+    void layoutTable(SimpleReportGenerator& report, const QJsonObject& item) const;
+    void layoutChart(SimpleReportGenerator& report, const QJsonObject& item) const;
+    void layoutSvg(SimpleReportGenerator& report, const QJsonObject& item) const;
+
+    QJsonObject description;
+    QString baseDir;
+  };
+
+}
+
+#endif // JSONREPORTBUILDER_H
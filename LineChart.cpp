@@ -1,7 +1,151 @@
+#include <stdexcept>
+
 #include "LineChart.h"
+#include "LineChartItem.h"
 
 namespace SimpleReportLib {
 
+  tuple<double, double> calcMinMax(const double* data, size_t n)
+  {
+    if ((data == nullptr) || (n == 0)) return make_tuple(0.0, 0.0);
+
+    // four independent lanes without any data-dependent branches;
+    // this pattern is auto-vectorized into packed min/max instructions
+    double mn[4] = {data[0], data[0], data[0], data[0]};
+    double mx[4] = {data[0], data[0], data[0], data[0]};
+    size_t i = 0;
+    for (; (i + 4) <= n; i += 4)
+    {
+      for (int lane = 0; lane < 4; ++lane)
+      {
+        const double v = data[i + lane];
+        mn[lane] = (v < mn[lane]) ? v : mn[lane];
+        mx[lane] = (v > mx[lane]) ? v : mx[lane];
+      }
+    }
+
+    // the remaining tail
+    for (; i < n; ++i)
+    {
+      const double v = data[i];
+      mn[0] = (v < mn[0]) ? v : mn[0];
+      mx[0] = (v > mx[0]) ? v : mx[0];
+    }
+
+    // merge the lanes
+    double minVal = mn[0];
+    double maxVal = mx[0];
+    for (int lane = 1; lane < 4; ++lane)
+    {
+      if (mn[lane] < minVal) minVal = mn[lane];
+      if (mx[lane] > maxVal) maxVal = mx[lane];
+    }
+
+    return make_tuple(minVal, maxVal);
+  }
+
+  //----------------------------------------------------------------------------
+
+  bool clipSegment(double& x0, double& y0, double& x1, double& y1, double xmin, double xmax, double ymin, double ymax)
+  {
+    // trivially reject segments that are completely on one side of the window
+    if ((x0 < xmin) && (x1 < xmin)) return false;
+    if ((x0 > xmax) && (x1 > xmax)) return false;
+    if ((y0 < ymin) && (y1 < ymin)) return false;
+    if ((y0 > ymax) && (y1 > ymax)) return false;
+
+    // trivially accept segments that are completely inside the window
+    auto isInside = [&](double x, double y) {
+      return ((x >= xmin) && (x <= xmax) && (y >= ymin) && (y <= ymax));
+    };
+    if (isInside(x0, y0) && isInside(x1, y1)) return true;
+
+    // determine the parameter range [t0, t1] of the visible part
+    // of the segment P(t) = P0 + t * (P1 - P0)
+    const double dx = x1 - x0;
+    const double dy = y1 - y0;
+    const double p[4] = {-dx, dx, -dy, dy};
+    const double q[4] = {x0 - xmin, xmax - x0, y0 - ymin, ymax - y0};
+    double t0 = 0.0;
+    double t1 = 1.0;
+    for (int k = 0; k < 4; ++k)
+    {
+      if (p[k] == 0)
+      {
+        // parallel to this boundary and outside of it
+        if (q[k] < 0) return false;
+        continue;
+      }
+
+      const double r = q[k] / p[k];
+      if (p[k] < 0)
+      {
+        if (r > t1) return false;
+        if (r > t0) t0 = r;
+      } else {
+        if (r < t0) return false;
+        if (r < t1) t1 = r;
+      }
+    }
+
+    // apply the new parameters; the end point has to be
+    // calculated first because it uses the original start point
+    x1 = x0 + t1 * dx;
+    y1 = y0 + t1 * dy;
+    x0 = x0 + t0 * dx;
+    y0 = y0 + t0 * dy;
+
+    return true;
+  }
+
+  //----------------------------------------------------------------------------
+
+  ChartTrace::ChartTrace(vector<double>&& _x, vector<double>&& _y)
+    :xOwned(std::move(_x)), yOwned(std::move(_y))
+  {
+    if (xOwned.size() != yOwned.size())
+    {
+      throw invalid_argument("Inconsistent array sizes for ChartTrace ctor!");
+    }
+
+    xPtr = xOwned.data();
+    yPtr = yOwned.data();
+    n = xOwned.size();
+
+    calcExtents();
+  }
+
+  //----------------------------------------------------------------------------
+
+  ChartTrace::ChartTrace(const double* _x, const double* _y, size_t _n, bool copyData)
+    :xPtr(_x), yPtr(_y), n(_n)
+  {
+    if ((_x == nullptr) || (_y == nullptr))
+    {
+      throw invalid_argument("Invalid data pointers for ChartTrace ctor!");
+    }
+
+    if (copyData)
+    {
+      xOwned.assign(_x, _x + _n);
+      yOwned.assign(_y, _y + _n);
+      xPtr = xOwned.data();
+      yPtr = yOwned.data();
+    }
+
+    calcExtents();
+  }
+
+  //----------------------------------------------------------------------------
+
+  void ChartTrace::calcExtents()
+  {
+    tie(xMin, xMax) = calcMinMax(xPtr, n);
+    tie(yMin, yMax) = calcMinMax(yPtr, n);
+  }
+
+  //----------------------------------------------------------------------------
+
   LineChart::LineChart(SimpleReportGenerator* _rep, double _x0, double _y0, double _w, double _h)
     :rep(_rep), x0(_x0), y0(_y0), w(_w), h(_h)
   {
@@ -13,17 +157,45 @@ namespace SimpleReportLib {
 
   //----------------------------------------------------------------------------
 
-  void LineChart::addTrace(vector<tuple<double, double> >& data)
+  void LineChart::addTrace(const vector<tuple<double, double> >& data)
   {
     if (data.size() == 0) return;
-    traces.push_back(data);
+
+    // split the tuples into separate x- and y-arrays
+    vector<double> x;
+    vector<double> y;
+    x.reserve(data.size());
+    y.reserve(data.size());
+    for (const auto& xy : data)
+    {
+      x.push_back(get<0>(xy));
+      y.push_back(get<1>(xy));
+    }
+
+    addTrace(std::move(x), std::move(y));
+  }
+
+  //----------------------------------------------------------------------------
+
+  void LineChart::addTrace(vector<double>&& x, vector<double>&& y)
+  {
+    if (x.size() == 0) return;
+    traces.push_back(make_shared<const ChartTrace>(std::move(x), std::move(y)));
+  }
+
+  //----------------------------------------------------------------------------
+
+  void LineChart::addTrace(const double* x, const double* y, size_t n, bool copyData)
+  {
+    if (n == 0) return;
+    traces.push_back(make_shared<const ChartTrace>(x, y, n, copyData));
   }
 
   //----------------------------------------------------------------------------
 
   void LineChart::render()
   {
-    if (traces.size() == 0) return;
+    if (!(hasData())) return;
 
     // get the extends of the X- and Y-data
     double xmin;
@@ -32,6 +204,18 @@ namespace SimpleReportLib {
     double ymax;
     tie(xmin, xmax, ymin, ymax) = get_XMin_XMax_YMin_YMax();
 
+    // avoid a division by zero for constant data
+    if (xmax <= xmin)
+    {
+      xmin -= 0.5;
+      xmax += 0.5;
+    }
+    if (ymax <= ymin)
+    {
+      ymin -= 0.5;
+      ymax += 0.5;
+    }
+
     render(xmin, xmax, ymin, ymax);
   }
 
@@ -39,55 +223,50 @@ namespace SimpleReportLib {
 
   void LineChart::render(double xmin, double xmax, double ymin, double ymax)
   {
-    if (traces.size() == 0) return;
-
-    // calculate the mapping from "values" to "millimeter" or "coordinates"
-    double facX = w / (xmax - xmin);
-    double facY = h / (ymax - ymin);
-
-    // a helper function to convert from "value" to "paper" coordinates
-    auto coordConversion = [&](const double x, const double y) {
-      double xOut = (x - xmin) * facX + x0;
-      double yOut = (y0 + h) - (y - ymin) * facY;
-      return make_tuple(xOut, yOut);
-    };
+    if (!(hasData())) return;
+    if ((xmax <= xmin) || (ymax <= ymin)) return;
 
     // draw the axes
     rep->drawVertLine(x0, y0, h, LINE_TYPE::THICK);
     rep->drawHorLine(x0, y0 + h, w, LINE_TYPE::THICK);
 
-    // draw trace by trace
-    for (auto trace : traces)
+    // draw the actual data
+    renderData(xmin, xmax, ymin, ymax);
+
+    // draw axis labels
+    renderLabels(xmin, xmax, ymin, ymax);
+  }
+
+  //----------------------------------------------------------------------------
+
+  void LineChart::renderData(double xmin, double xmax, double ymin, double ymax)
+  {
+    // each trace becomes a single item that paints itself directly
+    // from the trace data, depending on the current zoom level
+    QRectF plotRect = getPlotRect__internalUnits();
+    QPen tracePen = rep->lineType2Pen(LINE_TYPE::MED);
+    for (const auto& trace : traces)
     {
-      double prevX;
-      double prevY;
-      bool isFirst = true;
-      for (auto datapoint : trace)
-      {
-        double x;
-        double y;
-        tie(x, y) = datapoint;
-        tie(x, y) = coordConversion(x, y);
-        if (isFirst)
-        {
-          prevX = x;
-          prevY = y;
-          isFirst = false;
-        }
-
-        rep->drawLine(prevX, prevY, x, y);
-        prevX = x;
-        prevY = y;
-      }
+      // skip traces that are completely outside of the plot window;
+      // partially visible traces are clipped segment by segment
+      // when they're painted
+      if (!(isTraceInWindow(*trace, xmin, xmax, ymin, ymax))) continue;
+
+      auto item = make_unique<LineChartItem>(trace, xmin, xmax, ymin, ymax, plotRect, tracePen);
+      rep->addGraphicsItem(std::move(item));
     }
+  }
 
-    // draw axis labels
+  //----------------------------------------------------------------------------
+
+  void LineChart::renderLabels(double xmin, double xmax, double ymin, double ymax)
+  {
     for (auto xLabel : xLabels)
     {
       double x;
       QString txt;
       tie(x, txt) = xLabel;
-      tie(x, std::ignore) = coordConversion(x, 0);
+      tie(x, std::ignore) = valueToPaper(x, 0, xmin, xmax, ymin, ymax);
 
       // draw the tick
       QPointF tickPos(x, y0 + h);
@@ -100,7 +279,7 @@ namespace SimpleReportLib {
       double y;
       QString txt;
       tie(y, txt) = yLabel;
-      tie(std::ignore, y) = coordConversion(0, y);
+      tie(std::ignore, y) = valueToPaper(0, y, xmin, xmax, ymin, ymax);
 
       // draw the tick
       QPointF tickPos(x0, y);
@@ -112,32 +291,63 @@ namespace SimpleReportLib {
 
   //----------------------------------------------------------------------------
 
+  tuple<double, double> LineChart::valueToPaper(double x, double y, double xmin, double xmax, double ymin, double ymax) const
+  {
+    // the mapping from "values" to "millimeter"
+    double facX = w / (xmax - xmin);
+    double facY = h / (ymax - ymin);
+
+    double xOut = (x - xmin) * facX + x0;
+    double yOut = (y0 + h) - (y - ymin) * facY;
+    return make_tuple(xOut, yOut);
+  }
+
+  //----------------------------------------------------------------------------
+
+  QRectF LineChart::getPlotRect__internalUnits() const
+  {
+    return QRectF{x0 * ACCURACY_FAC, y0 * ACCURACY_FAC, w * ACCURACY_FAC, h * ACCURACY_FAC};
+  }
+
+  //----------------------------------------------------------------------------
+
+  bool LineChart::isTraceInWindow(const ChartTrace& trace, double xmin, double xmax, double ymin, double ymax)
+  {
+    double trXMin;
+    double trXMax;
+    double trYMin;
+    double trYMax;
+    tie(trXMin, trXMax, trYMin, trYMax) = trace.getExtents();
+
+    return !((trXMax < xmin) || (trXMin > xmax) || (trYMax < ymin) || (trYMin > ymax));
+  }
+
+  //----------------------------------------------------------------------------
+
   tuple<double, double, double, double> LineChart::get_XMin_XMax_YMin_YMax() const
   {
-    //
-    // THIS WILL FAIL IF THERE ISN'T AT LEAST ONE TRACE AVAILABLE!!
-    //
+    // a chart without data gets a unit range in both directions
+    if (traces.empty()) return make_tuple(0.0, 1.0, 0.0, 1.0);
+
+    // merge the pre-calculated extents of all traces
     double xmin;
     double xmax;
     double ymin;
     double ymax;
+    tie(xmin, xmax, ymin, ymax) = traces[0]->getExtents();
 
-    tie(xmin, ymin) = traces.at(0).at(0);
-    tie(xmax, ymax) = traces.at(0).at(0);
-
-    for (auto tr : traces)
+    for (const auto& tr : traces)
     {
-      for (auto xy : tr)
-      {
-        double x;
-        double y;
-        tie(x,y) = xy;
-
-        if (x < xmin) xmin = x;
-        if (y < ymin) ymin = y;
-        if (x > xmax) xmax = x;
-        if (y > ymax) ymax = y;
-      }
+      double trXMin;
+      double trXMax;
+      double trYMin;
+      double trYMax;
+      tie(trXMin, trXMax, trYMin, trYMax) = tr->getExtents();
+
+      if (trXMin < xmin) xmin = trXMin;
+      if (trYMin < ymin) ymin = trYMin;
+      if (trXMax > xmax) xmax = trXMax;
+      if (trYMax > ymax) ymax = trYMax;
     }
 
     return make_tuple(xmin, xmax, ymin, ymax);
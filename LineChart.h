@@ -21,6 +21,7 @@
 
 #include <vector>
 #include <tuple>
+#include <memory>
 
 //#include "simplereportgenerator_global.h"
 #include "SimpleReportGenerator.h"
@@ -29,6 +30,77 @@ using namespace std;
 
 namespace SimpleReportLib {
 
+  /** \brief Determines the minimum and the maximum of an array in a
+   * single pass.
+   *
+   * The loop uses several independent, branch-free accumulators so that the
+   * compiler can map it onto packed SIMD min/max instructions.
+   *
+   * \returns a tuple (min, max); (0, 0) for empty arrays
+   */
+  tuple<double, double> calcMinMax(
+      const double* data,   ///< pointer to the first value
+      size_t n   ///< number of values
+      );
+
+  /** \brief Clips a line segment against a rectangular window (Liang-Barsky)
+   *
+   * The end points are modified in place if the segment crosses the
+   * window boundary.
+   *
+   * \returns false if no part of the segment is inside the window
+   */
+  bool clipSegment(
+      double& x0,   ///< x-coordinate of the start point
+      double& y0,   ///< y-coordinate of the start point
+      double& x1,   ///< x-coordinate of the end point
+      double& y1,   ///< y-coordinate of the end point
+      double xmin,   ///< left boundary of the window
+      double xmax,   ///< right boundary of the window
+      double ymin,   ///< lower boundary of the window
+      double ymax   ///< upper boundary of the window
+      );
+
+  /** \brief A single data trace of a chart, stored as separate arrays
+   * for the x- and the y-values ("structure of arrays")
+   *
+   * The trace either owns its data (copied or moved in) or it is a non-owning
+   * view on arrays that are managed by the caller. In the latter case the caller
+   * has to guarantee that the arrays outlive the report pages that show the chart.
+   */
+  class ChartTrace
+  {
+  public:
+    ChartTrace(vector<double>&& _x, vector<double>&& _y);
+    ChartTrace(const double* _x, const double* _y, size_t _n, bool copyData);
+
+    // the data pointers are bound to the owned vectors, so no copies
+    ChartTrace(const ChartTrace& orig) = delete;
+    ChartTrace& operator=(const ChartTrace& orig) = delete;
+
+    inline const double* xData() const { return xPtr; }
+    inline const double* yData() const { return yPtr; }
+    inline size_t size() const { return n; }
+
+    /** \returns the extents of the trace as (xmin, xmax, ymin, ymax); they
+     * are calculated once when the trace is created
+     */
+    inline tuple<double, double, double, double> getExtents() const { return make_tuple(xMin, xMax, yMin, yMax); }
+
+  protected:
+    void calcExtents();
+
+    vector<double> xOwned;
+    vector<double> yOwned;
+    const double* xPtr;
+    const double* yPtr;
+    size_t n;
+    double xMin;
+    double xMax;
+    double yMin;
+    double yMax;
+  };
+
   class LineChart
   {
   public:
@@ -36,20 +108,65 @@ namespace SimpleReportLib {
     static constexpr double TICK_LENGTH__MM = 1.5;
 
     LineChart(SimpleReportGenerator* _rep, double _x0, double _y0, double _w, double _h);
-    void addTrace(vector<tuple<double, double>>& data);
+    virtual ~LineChart() = default;
+    void addTrace(const vector<tuple<double, double>>& data);
+
+    /** \brief Adds a trace by moving the caller's x- and y-vectors into the chart
+     *
+     * No data is copied. Both vectors must have the same length.
+     */
+    void addTrace(
+        vector<double>&& x,   ///< the x-values of the trace
+        vector<double>&& y   ///< the y-values of the trace
+        );
+
+    /** \brief Adds a trace from two plain arrays with `n` elements each
+     *
+     * If `copyData` is false, the chart only stores the pointers and the caller
+     * has to keep the arrays alive and unmodified as long as the rendered pages exist.
+     */
+    void addTrace(
+        const double* x,   ///< pointer to the first x-value
+        const double* y,   ///< pointer to the first y-value
+        size_t n,   ///< number of values in each array
+        bool copyData = true   ///< false: store a non-owning view instead of a copy
+        );
+
     void render();
     void render(double xmin, double xmax, double ymin, double ymax);
-    tuple<double, double, double, double> get_XMin_XMax_YMin_YMax() const;
+    virtual tuple<double, double, double, double> get_XMin_XMax_YMin_YMax() const;
     void addLabel_X(double x, const QString& txt);
     void addLabel_Y(double y, const QString& txt);
 
+    /** \returns true if the chart contains anything that can be rendered */
+    virtual bool hasData() const { return !(traces.empty()); }
+
   protected:
+    /** \brief Draws the actual data into the plot area; the axes have already been drawn
+     *
+     * Derived chart types override this to provide their own visualization
+     * while reusing the axes and the labels of the line chart.
+     */
+    virtual void renderData(double xmin, double xmax, double ymin, double ymax);
+
+    /** \brief Draws the ticks and the texts of all x- and y-labels */
+    void renderLabels(double xmin, double xmax, double ymin, double ymax);
+
+    /** \returns the paper coordinates (mm) of a point in value space for a given plot window */
+    tuple<double, double> valueToPaper(double x, double y, double xmin, double xmax, double ymin, double ymax) const;
+
+    /** \returns the plot area in internal units (mm * ACCURACY_FAC) */
+    QRectF getPlotRect__internalUnits() const;
+
+    /** \returns false if a trace is completely outside of a given plot window */
+    static bool isTraceInWindow(const ChartTrace& trace, double xmin, double xmax, double ymin, double ymax);
+
     SimpleReportGenerator* rep;
     double x0;
     double y0;
     double w;
     double h;
-    vector<vector<tuple<double, double>>> traces;
+    vector<shared_ptr<const ChartTrace>> traces;  // shared with the LineChartItems on the pages
     vector<tuple<double, QString>> xLabels;
     vector<tuple<double, QString>> yLabels;
   };
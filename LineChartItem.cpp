@@ -0,0 +1,240 @@
+/*
+ *    This is SimpleReportGenerator, a very basic report generator on top of Qt.
+ *    Copyright (C) 2014 - 2015  Volker Knollmann
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <stdexcept>
+
+#include <QPainter>
+#include <QPolygonF>
+#include <QStyleOptionGraphicsItem>
+
+#include "LineChartItem.h"
+
+namespace SimpleReportLib {
+
+  constexpr size_t LineChartItem::DECIMATION_BUCKET_SIZE;
+  constexpr size_t LineChartItem::MIN_POINTS_PER_LEVEL;
+  constexpr double LineChartItem::VERTICES_PER_PIXEL;
+
+  //----------------------------------------------------------------------------
+
+  LineChartItem::LineChartItem(const shared_ptr<const ChartTrace>& _trace, double _xmin, double _xmax, double _ymin, double _ymax, const QRectF& _plotRect, const QPen& _pen)
+    :xmin(_xmin), xmax(_xmax), ymin(_ymin), ymax(_ymax), plotRect(_plotRect), pen(_pen)
+  {
+    if ((_trace == nullptr) || (_trace->size() == 0) || (xmax <= xmin) || (ymax <= ymin) || plotRect.isEmpty())
+    {
+      throw invalid_argument("Invalid parameters for LineChartItem ctor!");
+    }
+
+    // the mapping from "values" to internal units
+    facX = plotRect.width() / (xmax - xmin);
+    facY = plotRect.height() / (ymax - ymin);
+
+    levels.push_back(_trace);
+    buildPyramid();
+
+    // the window is fixed, so we can count the points inside it once;
+    // the decimated levels are sorted if the original trace is sorted
+    const bool isSortedX = is_sorted(_trace->xData(), _trace->xData() + _trace->size());
+    for (const auto& lvl : levels)
+    {
+      pointsInWindow.push_back(countPointsInWindow(*lvl, isSortedX));
+    }
+
+    // we need the exposed rect in paint()
+    setFlag(QGraphicsItem::ItemUsesExtendedStyleOption);
+  }
+
+  //----------------------------------------------------------------------------
+
+  QRectF LineChartItem::boundingRect() const
+  {
+    // the trace is always clipped to the plot area, but lines
+    // on the border extend by half the pen width
+    double penMargin = pen.widthF() / 2.0;
+    return plotRect.adjusted(-penMargin, -penMargin, penMargin, penMargin);
+  }
+
+  //----------------------------------------------------------------------------
+
+  void LineChartItem::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget)
+  {
+    Q_UNUSED(widget);
+
+    // select the decimation level that matches the current zoom
+    const double lod = QStyleOptionGraphicsItem::levelOfDetailFromTransform(painter->worldTransform());
+    const ChartTrace& trace = *(levels[selectLevel(lod)]);
+
+    // convert the exposed area back into value space so that we
+    // only process the visible part of the trace
+    double clipXMin = xmin;
+    double clipXMax = xmax;
+    double clipYMin = ymin;
+    double clipYMax = ymax;
+    if (option != nullptr)
+    {
+      QRectF exposed = option->exposedRect.adjusted(-pen.widthF(), -pen.widthF(), pen.widthF(), pen.widthF());
+      clipXMin = max(xmin, xmin + (exposed.left() - plotRect.left()) / facX);
+      clipXMax = min(xmax, xmin + (exposed.right() - plotRect.left()) / facX);
+      clipYMin = max(ymin, ymin + (plotRect.bottom() - exposed.bottom()) / facY);
+      clipYMax = min(ymax, ymin + (plotRect.bottom() - exposed.top()) / facY);
+      if ((clipXMax < clipXMin) || (clipYMax < clipYMin)) return;
+    }
+
+    painter->save();
+    painter->setPen(pen);
+
+    // a helper function that converts from "value" to "item" coordinates
+    auto coordConversion = [&](double x, double y) {
+      return QPointF{plotRect.left() + (x - xmin) * facX, plotRect.bottom() - (y - ymin) * facY};
+    };
+
+    // collect connected, visible segments in a polyline and
+    // paint the polyline whenever the trace leaves the window
+    QPolygonF poly;
+    auto flush = [&]() {
+      if (poly.size() > 1) painter->drawPolyline(poly);
+      poly.clear();
+    };
+
+    const double* xData = trace.xData();
+    const double* yData = trace.yData();
+    for (size_t i = (trace.size() > 1) ? 1 : 0; i < trace.size(); ++i)
+    {
+      const size_t iPrev = (i > 0) ? (i - 1) : 0;
+      double segX0 = xData[iPrev];
+      double segY0 = yData[iPrev];
+      double segX1 = xData[i];
+      double segY1 = yData[i];
+      if (!(clipSegment(segX0, segY0, segX1, segY1, clipXMin, clipXMax, clipYMin, clipYMax)))
+      {
+        flush();
+        continue;
+      }
+
+      // start a new polyline if the start point has been clipped
+      bool isStartClipped = ((segX0 != xData[iPrev]) || (segY0 != yData[iPrev]));
+      if (isStartClipped || poly.isEmpty())
+      {
+        flush();
+        poly.append(coordConversion(segX0, segY0));
+      }
+      poly.append(coordConversion(segX1, segY1));
+
+      // finish the polyline if the end point has been clipped
+      if ((segX1 != xData[i]) || (segY1 != yData[i])) flush();
+    }
+    flush();
+
+    painter->restore();
+  }
+
+  //----------------------------------------------------------------------------
+
+  shared_ptr<const ChartTrace> LineChartItem::decimate(const ChartTrace& src)
+  {
+    const size_t n = src.size();
+    const double* xData = src.xData();
+    const double* yData = src.yData();
+
+    // each bucket is reduced to the points with the lowest and the highest
+    // y-value (in their original order) which preserves the visual envelope;
+    // the very first and the very last point are always retained
+    vector<double> x;
+    vector<double> y;
+    x.reserve(2 * (n / DECIMATION_BUCKET_SIZE) + 4);
+    y.reserve(2 * (n / DECIMATION_BUCKET_SIZE) + 4);
+    for (size_t start = 0; start < n; start += DECIMATION_BUCKET_SIZE)
+    {
+      const size_t end = min(start + DECIMATION_BUCKET_SIZE, n);
+      size_t iMin = start;
+      size_t iMax = start;
+      for (size_t i = start + 1; i < end; ++i)
+      {
+        if (yData[i] < yData[iMin]) iMin = i;
+        if (yData[i] > yData[iMax]) iMax = i;
+      }
+
+      size_t idx[4];
+      int cnt = 0;
+      if (start == 0) idx[cnt++] = 0;
+      idx[cnt++] = iMin;
+      idx[cnt++] = iMax;
+      if (end == n) idx[cnt++] = n - 1;
+      sort(idx, idx + cnt);
+      auto last = unique(idx, idx + cnt);
+
+      for (auto it = idx; it != last; ++it)
+      {
+        x.push_back(xData[*it]);
+        y.push_back(yData[*it]);
+      }
+    }
+
+    return make_shared<const ChartTrace>(std::move(x), std::move(y));
+  }
+
+  //----------------------------------------------------------------------------
+
+  void LineChartItem::buildPyramid()
+  {
+    while (levels.back()->size() > MIN_POINTS_PER_LEVEL)
+    {
+      auto next = decimate(*(levels.back()));
+
+      // stop if the decimation doesn't reduce the data anymore
+      if (next->size() >= levels.back()->size()) break;
+
+      levels.push_back(next);
+    }
+  }
+
+  //----------------------------------------------------------------------------
+
+  size_t LineChartItem::selectLevel(double lod) const
+  {
+    // the number of device pixels along the x-axis of the plot
+    const double devPixels = plotRect.width() * lod;
+    const double minVertices = devPixels * VERTICES_PER_PIXEL;
+
+    // use the coarsest level that still provides enough
+    // vertices inside the plot window
+    size_t lvl = 0;
+    while (((lvl + 1) < levels.size()) && (pointsInWindow[lvl + 1] >= minVertices)) ++lvl;
+
+    return lvl;
+  }
+
+  //----------------------------------------------------------------------------
+
+  size_t LineChartItem::countPointsInWindow(const ChartTrace& tr, bool isSortedX) const
+  {
+    const double* xBegin = tr.xData();
+    const double* xEnd = tr.xData() + tr.size();
+
+    if (isSortedX)
+    {
+      return upper_bound(xBegin, xEnd, xmax) - lower_bound(xBegin, xEnd, xmin);
+    }
+
+    return count_if(xBegin, xEnd, [this](double x) { return ((x >= xmin) && (x <= xmax)); });
+  }
+
+  //----------------------------------------------------------------------------
+
+}
@@ -0,0 +1,90 @@
+/*
+ *    This is SimpleReportGenerator, a very basic report generator on top of Qt.
+ *    Copyright (C) 2014 - 2015  Volker Knollmann
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LINECHARTITEM_H
+#define LINECHARTITEM_H
+
+#include <memory>
+#include <vector>
+
+#include <QGraphicsItem>
+#include <QPen>
+
+#include "LineChart.h"
+
+namespace SimpleReportLib {
+
+  /** \brief A graphics item that paints a single chart trace directly from its data
+   *
+   * The item keeps a shared reference to the trace and a pyramid of decimated
+   * copies of it. Depending on the current zoom level, paint() picks the coarsest
+   * level that still provides enough vertices inside the plot window for the
+   * visible resolution; only the points within [xmin, xmax] are counted, so
+   * that a small window into a long trace gets a fine level.
+   *
+   * The item's coordinates are the page's internal coordinates (mm * ACCURACY_FAC).
+   */
+  class LineChartItem : public QGraphicsItem
+  {
+  public:
+    /** \brief the number of source points that are merged into one bucket of the next coarser level */
+    static constexpr size_t DECIMATION_BUCKET_SIZE = 8;
+
+    /** \brief levels with fewer points than this are not decimated any further */
+    static constexpr size_t MIN_POINTS_PER_LEVEL = 2000;
+
+    /** \brief the minimum number of vertices per device pixel that a level must provide */
+    static constexpr double VERTICES_PER_PIXEL = 2.0;
+
+    LineChartItem(
+        const shared_ptr<const ChartTrace>& _trace,   ///< the data to be painted
+        double _xmin,   ///< the left boundary of the plot window in value space
+        double _xmax,   ///< the right boundary of the plot window in value space
+        double _ymin,   ///< the lower boundary of the plot window in value space
+        double _ymax,   ///< the upper boundary of the plot window in value space
+        const QRectF& _plotRect,   ///< the plot area in internal units
+        const QPen& _pen   ///< the pen for the trace (width in internal units)
+        );
+
+    virtual QRectF boundingRect() const override;
+    virtual void paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget = nullptr) override;
+
+    /** \returns the number of levels in the decimation pyramid, including the full resolution data */
+    inline size_t getLevelCount() const { return levels.size(); }
+
+  protected:
+    static shared_ptr<const ChartTrace> decimate(const ChartTrace& src);
+    void buildPyramid();
+    size_t selectLevel(double lod) const;
+    size_t countPointsInWindow(const ChartTrace& tr, bool isSortedX) const;
+
+    vector<shared_ptr<const ChartTrace>> levels;   // level 0 is the original trace
+    vector<size_t> pointsInWindow;   // the number of points within [xmin, xmax] per level
+    double xmin;
+    double xmax;
+    double ymin;
+    double ymax;
+    QRectF plotRect;
+    QPen pen;
+    double facX;
+    double facY;
+  };
+
+}
+
+#endif // LINECHARTITEM_H
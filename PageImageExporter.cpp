@@ -0,0 +1,197 @@
+/*
+ *    This is SimpleReportGenerator, a very basic report generator on top of Qt.
+ *    Copyright (C) 2014 - 2015  Volker Knollmann
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <stdexcept>
+#include <thread>
+
+#include <QDir>
+#include <QImageWriter>
+#include <QPainter>
+
+#include "PageImageExporter.h"
+#include "SimpleReportGenerator.h"
+
+using namespace std;
+
+namespace SimpleReportLib {
+
+  constexpr int PageImageExporter::MAX_QUEUED_IMAGES_PER_THREAD;
+
+  //----------------------------------------------------------------------------
+
+  PageImageExporter::PageImageExporter(const vector<QGraphicsScene*>& _pages, double _w, double _h)
+    :pages(_pages), w(_w), h(_h)
+  {
+    if ((w <= 0) || (h <= 0))
+    {
+      throw std::invalid_argument("Invalid parameters for PageImageExporter ctor!");
+    }
+  }
+
+  //----------------------------------------------------------------------------
+
+  ImageExportStats PageImageExporter::exportAll(const QString& dirName, int dpi, const QString& format, int nThreads)
+  {
+    ImageExportStats stats;
+    if ((dpi <= 0) || !(QDir{dirName}.exists()) || pages.empty()) return stats;
+
+    auto tStart = chrono::steady_clock::now();
+
+    // split the threads between rendering and encoding
+    if (nThreads <= 0) nThreads = max<int>(2, thread::hardware_concurrency());
+    nThreads = max(2, nThreads);
+    int nRenderers = min<int>(nThreads / 2, pages.size());
+    int nEncoders = nThreads - nRenderers;
+
+    outDir = dirName;
+    outFormat = format;
+    outDpi = dpi;
+    encodeQueue.clear();
+    maxQueueSize = static_cast<size_t>(nRenderers * MAX_QUEUED_IMAGES_PER_THREAD);
+    nextPage = 0;
+    activeRenderers = nRenderers;
+    exportedPages = 0;
+    failedPages = 0;
+
+    vector<thread> workers;
+    for (int i = 0; i < nRenderers; ++i) workers.push_back(thread{[this]() { renderLoop(); }});
+    for (int i = 0; i < nEncoders; ++i) workers.push_back(thread{[this]() { encodeLoop(); }});
+    for (thread& t : workers) t.join();
+
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - tStart;
+    stats.exportedPages = exportedPages;
+    stats.failedPages = failedPages;
+    stats.elapsed__s = elapsed.count();
+    if (stats.elapsed__s > 0) stats.pagesPerSecond = exportedPages / stats.elapsed__s;
+
+    return stats;
+  }
+
+  //----------------------------------------------------------------------------
+
+  QString PageImageExporter::pageFileName(int idxPage, int nPages, const QString& format)
+  {
+    int nDigits = QString::number(max(1, nPages)).length();
+    return QString{"page_%1.%2"}.arg(idxPage + 1, nDigits, 10, QChar{'0'}).arg(format.toLower());
+  }
+
+  //----------------------------------------------------------------------------
+
+  QImage PageImageExporter::renderPage(QGraphicsScene* sc, double w, double h, int dpi)
+  {
+    if (sc == nullptr) return QImage{};
+
+    // internal units --> mm --> inch --> pixels
+    const double pxPerUnit = dpi / (ACCURACY_FAC * 25.4);
+    int imgW = max(1, static_cast<int>(lround(w * pxPerUnit)));
+    int imgH = max(1, static_cast<int>(lround(h * pxPerUnit)));
+
+    QImage img{imgW, imgH, QImage::Format_ARGB32_Premultiplied};
+    img.fill(Qt::white);
+    int dotsPerMeter = static_cast<int>(lround(dpi / 0.0254));
+    img.setDotsPerMeterX(dotsPerMeter);
+    img.setDotsPerMeterY(dotsPerMeter);
+
+    QPainter painter{&img};
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setRenderHint(QPainter::TextAntialiasing);
+    sc->render(&painter, QRectF{0, 0, static_cast<double>(imgW), static_cast<double>(imgH)}, QRectF{0, 0, w, h}, Qt::IgnoreAspectRatio);
+    painter.end();
+
+    return img;
+  }
+
+  //----------------------------------------------------------------------------
+
+  void PageImageExporter::renderLoop()
+  {
+    while (true)
+    {
+      int idxPage;
+      {
+        lock_guard<mutex> lock{queueMutex};
+        idxPage = nextPage++;
+      }
+
+      if (idxPage >= static_cast<int>(pages.size())) break;
+
+      // rendering happens without any lock; each
+      // page is only handed out to a single thread
+      QImage img = renderPage(pages[idxPage], w, h, outDpi);
+
+      // wait for space in the encoder queue
+      unique_lock<mutex> lock{queueMutex};
+      queueNotFull.wait(lock, [this]() { return (encodeQueue.size() < maxQueueSize); });
+      encodeQueue.push_back(RenderedPage{idxPage, img});
+      lock.unlock();
+      queueNotEmpty.notify_one();
+    }
+
+    // the last renderer wakes up all encoders so that
+    // they can terminate when the queue is empty
+    {
+      lock_guard<mutex> lock{queueMutex};
+      --activeRenderers;
+    }
+    queueNotEmpty.notify_all();
+  }
+
+  //----------------------------------------------------------------------------
+
+  void PageImageExporter::encodeLoop()
+  {
+    const QDir dir{outDir};
+    const int nPages = static_cast<int>(pages.size());
+    const QByteArray fmt = outFormat.toLatin1();
+
+    while (true)
+    {
+      RenderedPage rp;
+      {
+        unique_lock<mutex> lock{queueMutex};
+        queueNotEmpty.wait(lock, [this]() { return (!(encodeQueue.empty()) || (activeRenderers == 0)); });
+        if (encodeQueue.empty()) return;
+
+        rp = std::move(encodeQueue.front());
+        encodeQueue.pop_front();
+      }
+      queueNotFull.notify_one();
+
+      bool isOkay = false;
+      if (!(rp.img.isNull()))
+      {
+        QImageWriter writer{dir.filePath(pageFileName(rp.idxPage, nPages, outFormat)), fmt};
+        isOkay = writer.write(rp.img);
+      }
+
+      lock_guard<mutex> lock{queueMutex};
+      if (isOkay)
+      {
+        ++exportedPages;
+      } else {
+        ++failedPages;
+      }
+    }
+  }
+
+  //----------------------------------------------------------------------------
+
+}
@@ -0,0 +1,115 @@
+/*
+ *    This is SimpleReportGenerator, a very basic report generator on top of Qt.
+ *    Copyright (C) 2014 - 2015  Volker Knollmann
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PAGEIMAGEEXPORTER_H
+#define PAGEIMAGEEXPORTER_H
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+#include <QGraphicsScene>
+#include <QImage>
+#include <QString>
+
+namespace SimpleReportLib {
+
+  /** \brief The result of an image export
+   */
+  struct ImageExportStats
+  {
+    int exportedPages{0};
+    int failedPages{0};   // pages that couldn't be rendered or written
+    double elapsed__s{0.0};
+    double pagesPerSecond{0.0};
+  };
+
+  /** \brief Renders report pages into raster images and writes them to files, using a pool of threads
+   *
+   * Rendering and encoding are pipelined: a set of render threads rasterizes the pages
+   * into QImages and a set of encoder threads writes the images to files. The number of
+   * rendered but not yet encoded images is bounded to limit the memory consumption.
+   *
+   * The output is deterministic: the file names only depend on the page index and all
+   * images are rendered with the same size and render hints, regardless of the scheduling.
+   *
+   * Each scene is only accessed by one thread at a time; however, the scenes must not be
+   * accessed by other threads (e.g., a viewer's tile cache) during the export.
+   */
+  class PageImageExporter
+  {
+  public:
+    /** \brief the max. number of images per render thread that wait for being encoded */
+    static constexpr int MAX_QUEUED_IMAGES_PER_THREAD = 2;
+
+    PageImageExporter(
+        const std::vector<QGraphicsScene*>& _pages,   ///< the pages to be exported
+        double _w,   ///< the page width in internal units
+        double _h   ///< the page height in internal units
+        );
+
+    /** \brief Exports all pages to "page_<n>.<format>" in a given directory
+     *
+     * \returns statistics about the export
+     */
+    ImageExportStats exportAll(
+        const QString& dirName,   ///< the output directory, must exist
+        int dpi,   ///< the resolution of the images
+        const QString& format,   ///< an image format supported by QImageWriter, e.g. "PNG" or "TIFF"
+        int nThreads = 0   ///< the total number of threads for rendering and encoding; 0 = number of cores
+        );
+
+    /** \returns the file name for a page (without directory); the page number is zero-padded */
+    static QString pageFileName(int idxPage, int nPages, const QString& format);
+
+    /** \brief Renders a single page into an image with white background */
+    static QImage renderPage(QGraphicsScene* sc, double w, double h, int dpi);
+
+  protected:
+    struct RenderedPage
+    {
+      int idxPage;
+      QImage img;
+    };
+
+    void renderLoop();
+    void encodeLoop();
+
+    std::vector<QGraphicsScene*> pages;
+    double w;
+    double h;
+
+    // the state of a running export
+    QString outDir;
+    QString outFormat;
+    int outDpi{0};
+    std::mutex queueMutex;   // protects everything below
+    std::condition_variable queueNotFull;
+    std::condition_variable queueNotEmpty;
+    std::deque<RenderedPage> encodeQueue;
+    size_t maxQueueSize{1};
+    int nextPage{0};
+    int activeRenderers{0};
+    int exportedPages{0};
+    int failedPages{0};
+  };
+
+}
+
+#endif // PAGEIMAGEEXPORTER_H
@@ -0,0 +1,101 @@
+/*
+ *    This is SimpleReportGenerator, a very basic report generator on top of Qt.
+ *    Copyright (C) 2014 - 2015  Volker Knollmann
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+#include <stdexcept>
+
+#include "PageThumbnailModel.h"
+
+namespace SimpleReportLib {
+
+  constexpr int PageThumbnailModel::DEFAULT_THUMBNAIL_WIDTH;
+
+  //----------------------------------------------------------------------------
+
+  PageThumbnailModel::PageThumbnailModel(PageTileCache* _cache, QObject* parent)
+    :QAbstractListModel(parent), cache(_cache)
+  {
+    if (cache == nullptr)
+    {
+      throw std::invalid_argument("Invalid parameters for PageThumbnailModel ctor!");
+    }
+
+    connect(cache, SIGNAL(thumbnailReady(int)), this, SLOT(onThumbnailReady(int)), Qt::QueuedConnection);
+  }
+
+  //----------------------------------------------------------------------------
+
+  void PageThumbnailModel::setPages(int nPages, const QSizeF& pageSize, int maxWidth)
+  {
+    beginResetModel();
+
+    pageCount = std::max(0, nPages);
+    scaleKey = PageTileCache::thumbnailScaleKey(pageSize, maxWidth);
+
+    // a blank page with the thumbnails' dimensions
+    double scale = PageTileCache::keyToScale(scaleKey);
+    int w = std::max(1, static_cast<int>(std::ceil(pageSize.width() * scale)));
+    int h = std::max(1, static_cast<int>(std::ceil(pageSize.height() * scale)));
+    placeholder = QImage{w, h, QImage::Format_ARGB32_Premultiplied};
+    placeholder.fill(Qt::white);
+
+    endResetModel();
+  }
+
+  //----------------------------------------------------------------------------
+
+  int PageThumbnailModel::rowCount(const QModelIndex& parent) const
+  {
+    return parent.isValid() ? 0 : pageCount;
+  }
+
+  //----------------------------------------------------------------------------
+
+  QVariant PageThumbnailModel::data(const QModelIndex& index, int role) const
+  {
+    if (!(index.isValid()) || (index.row() >= pageCount)) return QVariant{};
+
+    if (role == Qt::DisplayRole)
+    {
+      return QString::number(index.row() + 1);
+    }
+
+    if (role == Qt::DecorationRole)
+    {
+      // never blocks; missing thumbnails are queued and
+      // announced via onThumbnailReady() later
+      QImage img = cache->getThumbnail(index.row(), scaleKey);
+      return img.isNull() ? placeholder : img;
+    }
+
+    return QVariant{};
+  }
+
+  //----------------------------------------------------------------------------
+
+  void PageThumbnailModel::onThumbnailReady(int page)
+  {
+    if ((page < 0) || (page >= pageCount)) return;
+
+    QModelIndex idx = index(page);
+    emit dataChanged(idx, idx, QVector<int>{Qt::DecorationRole});
+  }
+
+  //----------------------------------------------------------------------------
+
+}
@@ -0,0 +1,67 @@
+/*
+ *    This is SimpleReportGenerator, a very basic report generator on top of Qt.
+ *    Copyright (C) 2014 - 2015  Volker Knollmann
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PAGETHUMBNAILMODEL_H
+#define PAGETHUMBNAILMODEL_H
+
+#include <QAbstractListModel>
+#include <QImage>
+#include <QSizeF>
+
+#include "PageTileCache.h"
+
+namespace SimpleReportLib {
+
+  /** \brief A list model with one entry per page that provides page thumbnails as decoration
+   *
+   * Thumbnails are only requested when a view asks for them, which means that
+   * only the thumbnails of visible list entries are rendered. Until a thumbnail
+   * is available, a blank placeholder of the same size is returned.
+   */
+  class PageThumbnailModel : public QAbstractListModel
+  {
+    Q_OBJECT
+
+  public:
+    /** \brief the default max. width of a thumbnail in pixels */
+    static constexpr int DEFAULT_THUMBNAIL_WIDTH = 120;
+
+    PageThumbnailModel(PageTileCache* _cache, QObject* parent = nullptr);
+
+    /** \brief Defines the number of pages and their size in internal units */
+    void setPages(int nPages, const QSizeF& pageSize, int maxWidth = DEFAULT_THUMBNAIL_WIDTH);
+
+    /** \returns the size of all thumbnails in pixels */
+    inline QSize getThumbnailSize() const { return placeholder.size(); }
+
+    virtual int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    virtual QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+
+  protected slots:
+    void onThumbnailReady(int page);
+
+  protected:
+    PageTileCache* cache;
+    int pageCount{0};
+    int scaleKey{1};
+    QImage placeholder;
+  };
+
+}
+
+#endif // PAGETHUMBNAILMODEL_H
@@ -0,0 +1,421 @@
+/*
+ *    This is SimpleReportGenerator, a very basic report generator on top of Qt.
+ *    Copyright (C) 2014 - 2015  Volker Knollmann
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <atomic>
+#include <cmath>
+
+#include <QPainter>
+
+#include "PageTileCache.h"
+
+namespace SimpleReportLib {
+
+  constexpr int PageTileCache::TILE_SIZE;
+  constexpr double PageTileCache::SCALE_QUANTIZATION;
+  constexpr int PageTileCache::DEFAULT_CACHE_SIZE__KB;
+  constexpr int PageTileCache::DEFAULT_THUMBNAIL_CACHE_SIZE__KB;
+
+  //----------------------------------------------------------------------------
+
+  PageTileCache::PageTileCache(QObject* parent)
+    :QObject(parent)
+  {
+    cache.setMaxCost(DEFAULT_CACHE_SIZE__KB);
+    thumbnailCache.setMaxCost(DEFAULT_THUMBNAIL_CACHE_SIZE__KB);
+
+    worker = std::thread([this]() { workerLoop(); });
+  }
+
+  //----------------------------------------------------------------------------
+
+  PageTileCache::~PageTileCache()
+  {
+    {
+      std::lock_guard<std::mutex> lock{queueMutex};
+      stopWorker = true;
+    }
+    queueCondition.notify_all();
+    worker.join();
+  }
+
+  //----------------------------------------------------------------------------
+
+  void PageTileCache::setReport(SimpleReportGenerator* r, std::shared_ptr<const PicturePageList> pics)
+  {
+    {
+      std::lock_guard<std::mutex> lock{queueMutex};
+      visibleQueue.clear();
+      prefetchQueue.clear();
+      thumbnailQueue.clear();
+      pending.clear();
+      pendingThumbnails.clear();
+      cache.clear();
+      thumbnailCache.clear();
+      isReleasePending = false;
+      ++reportGeneration;
+    }
+    std::atomic_store(&picturePages, std::move(pics));
+
+    // wait for a tile that is currently being rendered
+    // from the old report
+    std::lock_guard<std::mutex> sceneLock{sceneMutex};
+    report = r;
+    usedScenePages.clear();
+  }
+
+  //----------------------------------------------------------------------------
+
+  void PageTileCache::setPicturePages(std::shared_ptr<const PicturePageList> pics)
+  {
+    std::atomic_store(&picturePages, std::move(pics));
+  }
+
+  //----------------------------------------------------------------------------
+
+  QImage PageTileCache::getTile(const PageTileKey& key, PRIORITY prio)
+  {
+    {
+      std::lock_guard<std::mutex> lock{queueMutex};
+
+      QImage* img = cache.object(key);
+      if (img != nullptr) return *img;   // implicitly shared, no deep copy
+
+      if (!(pending.contains(key)))
+      {
+        pending.insert(key);
+        if (prio == PRIORITY::VISIBLE)
+        {
+          visibleQueue.push_back(key);
+        } else {
+          prefetchQueue.push_back(key);
+        }
+      }
+    }
+
+    queueCondition.notify_one();
+    return QImage{};
+  }
+
+  //----------------------------------------------------------------------------
+
+  QImage PageTileCache::peekTile(const PageTileKey& key)
+  {
+    std::lock_guard<std::mutex> lock{queueMutex};
+
+    QImage* img = cache.object(key);
+    return (img != nullptr) ? *img : QImage{};
+  }
+
+  //----------------------------------------------------------------------------
+
+  void PageTileCache::requestRegion(int page, int scaleKey, const QRectF& sceneRect, PRIORITY prio)
+  {
+    if (sceneRect.isEmpty()) return;
+
+    const double tileExtent = TILE_SIZE / keyToScale(scaleKey);
+    const int tx0 = std::max(0, static_cast<int>(std::floor(sceneRect.left() / tileExtent)));
+    const int ty0 = std::max(0, static_cast<int>(std::floor(sceneRect.top() / tileExtent)));
+    const int tx1 = static_cast<int>(std::ceil(sceneRect.right() / tileExtent));
+    const int ty1 = static_cast<int>(std::ceil(sceneRect.bottom() / tileExtent));
+
+    for (int ty = ty0; ty < ty1; ++ty)
+    {
+      for (int tx = tx0; tx < tx1; ++tx)
+      {
+        getTile(PageTileKey{page, scaleKey, tx, ty}, prio);
+      }
+    }
+  }
+
+  //----------------------------------------------------------------------------
+
+  void PageTileCache::cancelPending()
+  {
+    std::lock_guard<std::mutex> lock{queueMutex};
+    visibleQueue.clear();
+    prefetchQueue.clear();
+    pending.clear();
+  }
+
+  //----------------------------------------------------------------------------
+
+  QImage PageTileCache::getThumbnail(int page, int scaleKey)
+  {
+    PageTileKey key{page, scaleKey, 0, 0};
+
+    {
+      std::lock_guard<std::mutex> lock{queueMutex};
+
+      QImage* img = thumbnailCache.object(key);
+      if (img != nullptr) return *img;
+
+      if (pendingThumbnails.contains(key)) return QImage{};
+      pendingThumbnails.insert(key);
+      thumbnailQueue.push_back(key);
+    }
+
+    queueCondition.notify_one();
+    return QImage{};
+  }
+
+  //----------------------------------------------------------------------------
+
+  void PageTileCache::cancelPendingThumbnails()
+  {
+    std::lock_guard<std::mutex> lock{queueMutex};
+    thumbnailQueue.clear();
+    pendingThumbnails.clear();
+  }
+
+  //----------------------------------------------------------------------------
+
+  int PageTileCache::thumbnailScaleKey(const QSizeF& pageSize, int maxWidth)
+  {
+    if (pageSize.isEmpty() || (maxWidth < 1)) return 1;
+
+    double scale = std::min(std::min(maxWidth, TILE_SIZE) / pageSize.width(), TILE_SIZE / pageSize.height());
+
+    // round down so that the page never exceeds the tile
+    return std::max(1, static_cast<int>(std::floor(scale * SCALE_QUANTIZATION)));
+  }
+
+  //----------------------------------------------------------------------------
+
+  void PageTileCache::releasePagesOutside(int firstPage, int lastPage)
+  {
+    {
+      std::lock_guard<std::mutex> lock{queueMutex};
+      for (const PageTileKey& key : cache.keys())
+      {
+        if ((key.page < firstPage) || (key.page > lastPage)) cache.remove(key);
+      }
+
+      // the scenes are released by the worker, because
+      // it might be rendering one of them right now
+      retainedFirstPage = firstPage;
+      retainedLastPage = lastPage;
+      isReleasePending = true;
+    }
+
+    queueCondition.notify_one();
+  }
+
+  //----------------------------------------------------------------------------
+
+  void PageTileCache::setCacheSize(int sizeKB)
+  {
+    std::lock_guard<std::mutex> lock{queueMutex};
+    cache.setMaxCost(sizeKB);
+  }
+
+  //----------------------------------------------------------------------------
+
+  std::unique_lock<std::mutex> PageTileCache::lockScenes()
+  {
+    return std::unique_lock<std::mutex>{sceneMutex};
+  }
+
+  //----------------------------------------------------------------------------
+
+  int PageTileCache::scaleToKey(double scale)
+  {
+    return std::max(1, static_cast<int>(std::lround(scale * SCALE_QUANTIZATION)));
+  }
+
+  //----------------------------------------------------------------------------
+
+  double PageTileCache::keyToScale(int scaleKey)
+  {
+    return scaleKey / SCALE_QUANTIZATION;
+  }
+
+  //----------------------------------------------------------------------------
+
+  QRectF PageTileCache::tileRect(const PageTileKey& key)
+  {
+    const double tileExtent = TILE_SIZE / keyToScale(key.scaleKey);
+    return QRectF{key.tx * tileExtent, key.ty * tileExtent, tileExtent, tileExtent};
+  }
+
+  //----------------------------------------------------------------------------
+
+  void PageTileCache::workerLoop()
+  {
+    while (true)
+    {
+      // wait for the next job; visible tiles always go first,
+      // then pending releases; thumbnails take precedence over prefetching
+      PageTileKey key;
+      int generation;
+      bool isThumbnail;
+      {
+        std::unique_lock<std::mutex> lock{queueMutex};
+        queueCondition.wait(lock, [this]() {
+          return (stopWorker || isReleasePending || !(visibleQueue.empty()) || !(thumbnailQueue.empty()) || !(prefetchQueue.empty()));
+        });
+        if (stopWorker) return;
+
+        if (isReleasePending && visibleQueue.empty())
+        {
+          isReleasePending = false;
+          const int first = retainedFirstPage;
+          const int last = retainedLastPage;
+          generation = reportGeneration;
+          lock.unlock();
+
+          releaseScenesOutside(first, last, generation);
+          continue;
+        }
+
+        isThumbnail = (visibleQueue.empty() && !(thumbnailQueue.empty()));
+        std::deque<PageTileKey>& q = !(visibleQueue.empty()) ? visibleQueue : (isThumbnail ? thumbnailQueue : prefetchQueue);
+        key = q.front();
+        q.pop_front();
+        generation = reportGeneration;
+      }
+
+      QImage img = isThumbnail ? renderThumbnail(key) : renderTile(key);
+
+      // store the result, unless the report has been
+      // replaced in the meantime
+      {
+        std::lock_guard<std::mutex> lock{queueMutex};
+        (isThumbnail ? pendingThumbnails : pending).remove(key);
+        if ((generation != reportGeneration) || img.isNull()) continue;
+
+        int costKB = std::max(1, static_cast<int>(img.sizeInBytes() / 1024));
+        (isThumbnail ? thumbnailCache : cache).insert(key, new QImage{img}, costKB);
+      }
+
+      // we're on the worker thread; the signal is
+      // delivered as a queued signal to the GUI thread
+      if (isThumbnail)
+      {
+        emit thumbnailReady(key.page);
+      } else {
+        emit tileReady(key.page);
+      }
+    }
+  }
+
+  //----------------------------------------------------------------------------
+
+  QImage PageTileCache::renderTile(const PageTileKey& key)
+  {
+    // recorded pages don't need the scene lock
+    auto pics = std::atomic_load(&picturePages);
+    if (pics != nullptr) return renderPictureTile(key, *pics);
+
+    std::lock_guard<std::mutex> sceneLock{sceneMutex};
+
+    if (report == nullptr) return QImage{};
+    if ((key.page < 0) || (key.page >= report->getPageCount())) return QImage{};
+    QGraphicsScene* sc = report->getPage(key.page);
+    if (sc == nullptr) return QImage{};
+    usedScenePages.insert(key.page);
+
+    // areas outside of the page remain transparent
+    QImage img{TILE_SIZE, TILE_SIZE, QImage::Format_ARGB32_Premultiplied};
+    img.fill(Qt::transparent);
+
+    QPainter painter{&img};
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setRenderHint(QPainter::TextAntialiasing);
+    sc->render(&painter, QRectF{0, 0, TILE_SIZE, TILE_SIZE}, tileRect(key), Qt::IgnoreAspectRatio);
+    painter.end();
+
+    return img;
+  }
+
+  //----------------------------------------------------------------------------
+
+  QImage PageTileCache::renderThumbnail(const PageTileKey& key)
+  {
+    QImage img = renderTile(key);
+    if (img.isNull()) return img;
+
+    // crop the tile to the page
+    std::lock_guard<std::mutex> sceneLock{sceneMutex};
+    if (report == nullptr) return QImage{};
+    const double scale = keyToScale(key.scaleKey);
+    int w = std::min(TILE_SIZE, static_cast<int>(std::ceil(report->getPageWidth() * ACCURACY_FAC * scale)));
+    int h = std::min(TILE_SIZE, static_cast<int>(std::ceil(report->getPageHeight() * ACCURACY_FAC * scale)));
+
+    return img.copy(0, 0, std::max(1, w), std::max(1, h));
+  }
+
+  //----------------------------------------------------------------------------
+
+  void PageTileCache::releaseScenesOutside(int firstPage, int lastPage, int generation)
+  {
+    std::lock_guard<std::mutex> sceneLock{sceneMutex};
+
+    // only look at the pages that we've decoded ourselves instead of
+    // the whole report; that keeps scrolling cheap for long reports
+    if (report == nullptr) return;
+    {
+      std::lock_guard<std::mutex> lock{queueMutex};
+      if (generation != reportGeneration) return;
+    }
+
+    for (auto it = usedScenePages.begin(); it != usedScenePages.end(); )
+    {
+      const int idx = *it;
+      if ((idx >= firstPage) && (idx <= lastPage))
+      {
+        ++it;
+        continue;
+      }
+
+      // pages that can't be released stay in memory anyway
+      report->releasePage(idx);
+      it = usedScenePages.erase(it);
+    }
+  }
+
+  //----------------------------------------------------------------------------
+
+  QImage PageTileCache::renderPictureTile(const PageTileKey& key, const PicturePageList& pics)
+  {
+    if ((key.page < 0) || (key.page >= static_cast<int>(pics.size()))) return QImage{};
+    const std::shared_ptr<const QPicture>& pic = pics[key.page];
+    if (pic == nullptr) return QImage{};
+
+    QImage img{TILE_SIZE, TILE_SIZE, QImage::Format_ARGB32_Premultiplied};
+    img.fill(Qt::transparent);
+
+    QPainter painter{&img};
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setRenderHint(QPainter::TextAntialiasing);
+    const double scale = keyToScale(key.scaleKey);
+    painter.scale(scale, scale);
+    painter.translate(-tileRect(key).topLeft());
+
+    // the picture is shared with the GUI thread; replay
+    // a private copy (see PictureItem::paint())
+    QPicture privateCopy;
+    privateCopy.setData(pic->data(), pic->size());
+    painter.drawPicture(0, 0, privateCopy);
+    painter.end();
+
+    return img;
+  }
+
+  //----------------------------------------------------------------------------
+
+}
@@ -0,0 +1,211 @@
+/*
+ *    This is SimpleReportGenerator, a very basic report generator on top of Qt.
+ *    Copyright (C) 2014 - 2015  Volker Knollmann
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PAGETILECACHE_H
+#define PAGETILECACHE_H
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include <QObject>
+#include <QSizeF>
+#include <QCache>
+#include <QImage>
+#include <QPicture>
+#include <QSet>
+
+#include "SimpleReportGenerator.h"
+
+namespace SimpleReportLib {
+
+  /** \brief Recorded pages, one display list per page in internal units (see PictureItem::recordScene()) */
+  using PicturePageList = std::vector<std::shared_ptr<const QPicture>>;
+
+  /** \brief Identifies a single rendered tile: page, quantized scale and tile position
+   */
+  struct PageTileKey
+  {
+    int page;
+    int scaleKey;   // see PageTileCache::scaleToKey()
+    int tx;
+    int ty;
+
+    inline bool operator==(const PageTileKey& other) const
+    {
+      return ((page == other.page) && (scaleKey == other.scaleKey) && (tx == other.tx) && (ty == other.ty));
+    }
+  };
+
+  inline uint qHash(const PageTileKey& k, uint seed = 0)
+  {
+    return ::qHash(k.page, seed) ^ ::qHash(k.scaleKey, seed + 1) ^ ::qHash((k.tx << 16) ^ k.ty, seed + 2);
+  }
+
+  /** \brief A cache of rendered page images that are produced on a background thread
+   *
+   * Pages are split into square tiles of TILE_SIZE device pixels for a given scale
+   * (device pixels per internal unit). Requested tiles that are not yet available are
+   * queued and rendered by a single worker thread; tileReady() is emitted whenever a
+   * tile has been finished.
+   *
+   * In addition, the cache produces page thumbnails. They're rendered by the same worker
+   * after the visible tiles and kept in a separate, smaller cache so that they don't
+   * compete with the page tiles.
+   *
+   * All access to the report's scenes from the worker thread is serialized through
+   * a mutex that other users of the scenes (e.g., printing) can acquire as well.
+   *
+   * Reports that are still being laid out (see ReportProducer) are rendered from
+   * their recorded pages instead (see setPicturePages()). The list is replaced as a
+   * whole whenever pages are added, so neither side needs the scene mutex for them.
+   */
+  class PageTileCache : public QObject
+  {
+    Q_OBJECT
+
+  public:
+    /** \brief the width and height of a tile in device pixels */
+    static constexpr int TILE_SIZE = 256;
+
+    /** \brief the scale quantization; scales are stored as multiples of 1/SCALE_QUANTIZATION */
+    static constexpr double SCALE_QUANTIZATION = 65536.0;
+
+    /** \brief the default cache size in kB */
+    static constexpr int DEFAULT_CACHE_SIZE__KB = 256 * 1024;
+
+    /** \brief the default size of the thumbnail cache in kB */
+    static constexpr int DEFAULT_THUMBNAIL_CACHE_SIZE__KB = 32 * 1024;
+
+    enum class PRIORITY {
+      VISIBLE,
+      PREFETCH
+    };
+
+    explicit PageTileCache(QObject* parent = nullptr);
+    virtual ~PageTileCache();
+
+    /** \brief Assigns a new report; drops all cached tiles and pending requests
+     *
+     * If recorded pages are given, the tiles are rendered from them instead of
+     * the report's scenes, see setPicturePages().
+     */
+    void setReport(
+        SimpleReportGenerator* r,   ///< the report, may be null
+        std::shared_ptr<const PicturePageList> pics = nullptr   ///< the report's recorded pages, if any
+        );
+
+    /** \brief Renders the tiles of the current report from recorded pages instead of its scenes
+     *
+     * The list must contain the report's pages in order and must not be modified
+     * afterwards; pass a new list when pages have been added. Tiles that have
+     * already been rendered remain valid. nullptr switches back to the scenes.
+     */
+    void setPicturePages(std::shared_ptr<const PicturePageList> pics);
+
+    /** \returns a cached tile or a null image; in the latter case the tile is queued for rendering */
+    QImage getTile(const PageTileKey& key, PRIORITY prio = PRIORITY::VISIBLE);
+
+    /** \returns a cached tile or a null image; never queues a tile for rendering */
+    QImage peekTile(const PageTileKey& key);
+
+    /** \brief Queues all tiles of a page that intersect a given scene rect, unless they're cached */
+    void requestRegion(int page, int scaleKey, const QRectF& sceneRect, PRIORITY prio);
+
+    /** \brief Drops all tile requests that haven't been started yet; thumbnail requests are not affected */
+    void cancelPending();
+
+    /** \returns a cached thumbnail of a page or a null image; in the latter case the thumbnail is queued for rendering
+     *
+     * The thumbnail shows the whole page at the given scale and thus the page has to fit into
+     * a single tile at that scale, see thumbnailScaleKey().
+     */
+    QImage getThumbnail(int page, int scaleKey);
+
+    /** \brief Drops all thumbnail requests that haven't been started yet */
+    void cancelPendingThumbnails();
+
+    /** \returns the largest scale key for which a page of the given size (internal units) fits into a thumbnail of max. width x TILE_SIZE pixels */
+    static int thumbnailScaleKey(const QSizeF& pageSize, int maxWidth);
+
+    /** \brief Drops all cached tiles of pages outside of [firstPage, lastPage], e.g. far away from the viewport
+     *
+     * The worker thread also releases the scenes that it has used for pages outside
+     * of the range, if the report can restore them (see SimpleReportGenerator::releasePage()).
+     * That only works for loaded reports; the scenes of generated reports are the only
+     * copy of their content and thus stay in memory, no matter how many pages there are.
+     *
+     * Doesn't wait for the worker thread.
+     */
+    void releasePagesOutside(int firstPage, int lastPage);
+
+    /** \brief Sets the max. size of the cache in kB */
+    void setCacheSize(int sizeKB);
+
+    /** \returns a lock on the report's scenes; hold it while accessing the scenes from any thread */
+    std::unique_lock<std::mutex> lockScenes();
+
+    /** \returns the quantized representation of a scale (device pixels per internal unit) */
+    static int scaleToKey(double scale);
+
+    /** \returns the scale for a quantized scale key */
+    static double keyToScale(int scaleKey);
+
+    /** \returns the rectangle in scene coordinates that is covered by a tile */
+    static QRectF tileRect(const PageTileKey& key);
+
+  signals:
+    void tileReady(int page);
+    void thumbnailReady(int page);
+
+  protected:
+    void workerLoop();
+    QImage renderTile(const PageTileKey& key);
+    QImage renderPictureTile(const PageTileKey& key, const PicturePageList& pics);
+    QImage renderThumbnail(const PageTileKey& key);
+    void releaseScenesOutside(int firstPage, int lastPage, int generation);
+
+    SimpleReportGenerator* report{nullptr};
+    std::shared_ptr<const PicturePageList> picturePages;   // only accessed through std::atomic_load() / std::atomic_store()
+
+    std::mutex sceneMutex;
+    QSet<int> usedScenePages;   // pages whose scenes the worker has rendered since their last release; protected by sceneMutex
+
+    std::mutex queueMutex;   // protects the queue, the pending set, the cache and the stop flag
+    std::condition_variable queueCondition;
+    std::deque<PageTileKey> visibleQueue;
+    std::deque<PageTileKey> prefetchQueue;
+    std::deque<PageTileKey> thumbnailQueue;
+    QSet<PageTileKey> pending;
+    QSet<PageTileKey> pendingThumbnails;
+    QCache<PageTileKey, QImage> cache;
+    QCache<PageTileKey, QImage> thumbnailCache;   // LRU, independent of the tile cache
+    bool stopWorker{false};
+    bool isReleasePending{false};   // set by releasePagesOutside(), reset by the worker
+    int retainedFirstPage{0};   // the range of pages whose scenes are kept
+    int retainedLastPage{0};
+    int reportGeneration{0};   // incremented for each new report; invalidates in-flight results
+
+    std::thread worker;
+  };
+
+}
+
+#endif // PAGETILECACHE_H
@@ -0,0 +1,168 @@
+/*
+ *    This is SimpleReportGenerator, a very basic report generator on top of Qt.
+ *    Copyright (C) 2014 - 2015  Volker Knollmann
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+#include <stdexcept>
+
+#include <QPainter>
+#include <QPdfWriter>
+#include <QSet>
+#include <QStyleOptionGraphicsItem>
+
+#include "PdfExporter.h"
+#include "SimpleReportGenerator.h"
+
+namespace SimpleReportLib {
+
+  constexpr int PdfExporter::MAX_SHARED_SVG_PIXELS;
+
+  //----------------------------------------------------------------------------
+
+  PdfExporter::PdfExporter(const std::vector<QGraphicsScene*>& _pages, double _w, double _h)
+    :pages(_pages), w(_w), h(_h)
+  {
+    if ((w <= 0) || (h <= 0))
+    {
+      throw std::invalid_argument("Invalid parameters for PdfExporter ctor!");
+    }
+  }
+
+  //----------------------------------------------------------------------------
+
+  bool PdfExporter::exportPdf(const QString& fileName, const PdfExportOptions& options)
+  {
+    if (pages.empty() || (options.resolution <= 0) || (options.sharedSvgDpi < 0)) return false;
+
+    QPdfWriter writer{fileName};
+    writer.setResolution(options.resolution);
+    writer.setPageSize(QPageSize{QSizeF{w / ACCURACY_FAC, h / ACCURACY_FAC}, QPageSize::Millimeter});
+    writer.setPageMargins(QMarginsF{0, 0, 0, 0});
+    writer.setTitle(options.title);
+    writer.setCreator(options.creator);
+
+    svgPageCount.clear();
+    sharedSvgImages.clear();
+    if (options.shareRepeatedSvgs) findRepeatedSvgs();
+
+    QPainter painter;
+    if (!(painter.begin(&writer))) return false;
+    painter.setRenderHint(QPainter::Antialiasing);
+
+    // internal units --> mm --> PDF device units
+    const double scale = options.resolution / (25.4 * ACCURACY_FAC);
+    const int sharedSvgDpi = (options.sharedSvgDpi > 0) ? options.sharedSvgDpi : options.resolution;
+    const QRectF pageRect{0, 0, w, h};
+
+    for (size_t idx = 0; idx < pages.size(); ++idx)
+    {
+      if ((idx > 0) && !(writer.newPage())) return false;
+
+      QGraphicsScene* sc = pages[idx];
+      if (sc == nullptr) continue;
+
+      painter.save();
+      painter.scale(scale, scale);
+      painter.setClipRect(pageRect);
+
+      // paint all items bottom-up, just like QGraphicsScene::render(),
+      // but with the chance to substitute repeated content
+      for (QGraphicsItem* item : sc->items(Qt::AscendingOrder))
+      {
+        if (!(item->isVisible())) continue;
+
+        painter.save();
+        painter.setTransform(item->sceneTransform(), true);
+        painter.setOpacity(item->effectiveOpacity());
+
+        QByteArray svgHash = item->data(ITEM_DATA__SVG_CONTENT_HASH).toByteArray();
+        if (!(svgHash.isEmpty()) && (svgPageCount.value(svgHash, 0) > 1))
+        {
+          painter.drawImage(item->boundingRect(), getSharedSvgImage(item, sharedSvgDpi));
+        } else {
+          QStyleOptionGraphicsItem opt;
+          opt.exposedRect = item->boundingRect();
+          opt.rect = opt.exposedRect.toAlignedRect();
+          item->paint(&painter, &opt, nullptr);
+        }
+
+        painter.restore();
+      }
+
+      painter.restore();
+    }
+
+    return painter.end();
+  }
+
+  //----------------------------------------------------------------------------
+
+  void PdfExporter::findRepeatedSvgs()
+  {
+    // count the pages on which each SVG content occurs
+    for (QGraphicsScene* sc : pages)
+    {
+      if (sc == nullptr) continue;
+
+      QSet<QByteArray> hashesOnPage;
+      for (QGraphicsItem* item : sc->items())
+      {
+        QByteArray svgHash = item->data(ITEM_DATA__SVG_CONTENT_HASH).toByteArray();
+        if (!(svgHash.isEmpty())) hashesOnPage.insert(svgHash);
+      }
+
+      for (const QByteArray& svgHash : hashesOnPage) ++svgPageCount[svgHash];
+    }
+  }
+
+  //----------------------------------------------------------------------------
+
+  QImage PdfExporter::getSharedSvgImage(QGraphicsItem* item, int dpi)
+  {
+    // the image size depends on the item's size on the page
+    QRectF sceneBox = item->sceneBoundingRect();
+    double pxPerUnit = dpi / (25.4 * ACCURACY_FAC);
+    const double nPixels = sceneBox.width() * sceneBox.height() * pxPerUnit * pxPerUnit;
+    if (nPixels > MAX_SHARED_SVG_PIXELS) pxPerUnit *= std::sqrt(MAX_SHARED_SVG_PIXELS / nPixels);
+    int imgW = std::max(1, static_cast<int>(std::lround(sceneBox.width() * pxPerUnit)));
+    int imgH = std::max(1, static_cast<int>(std::lround(sceneBox.height() * pxPerUnit)));
+
+    // the same QImage instance (and thus the same cache key) for
+    // all occurrences; this makes the PDF engine write it only once
+    QByteArray key = item->data(ITEM_DATA__SVG_CONTENT_HASH).toByteArray();
+    key += QByteArray::number(imgW) + "x" + QByteArray::number(imgH);
+    auto it = sharedSvgImages.constFind(key);
+    if (it != sharedSvgImages.constEnd()) return it.value();
+
+    QImage img{imgW, imgH, QImage::Format_ARGB32_Premultiplied};
+    img.fill(Qt::transparent);
+    SvgItem* svgItem = dynamic_cast<SvgItem*>(item);
+    if (svgItem != nullptr)
+    {
+      QPainter imgPainter{&img};
+      imgPainter.setRenderHint(QPainter::Antialiasing);
+      svgItem->render(&imgPainter, QRectF{0, 0, static_cast<double>(imgW), static_cast<double>(imgH)});
+      imgPainter.end();
+    }
+
+    sharedSvgImages.insert(key, img);
+    return img;
+  }
+
+  //----------------------------------------------------------------------------
+
+}
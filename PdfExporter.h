@@ -0,0 +1,92 @@
+/*
+ *    This is SimpleReportGenerator, a very basic report generator on top of Qt.
+ *    Copyright (C) 2014 - 2015  Volker Knollmann
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PDFEXPORTER_H
+#define PDFEXPORTER_H
+
+#include <vector>
+
+#include <QGraphicsScene>
+#include <QHash>
+#include <QImage>
+#include <QString>
+
+namespace SimpleReportLib {
+
+  /** \brief Options for the PDF export
+   */
+  struct PdfExportOptions
+  {
+    QString title;   ///< the document title in the PDF metadata
+    QString creator;   ///< the creator in the PDF metadata
+    int resolution{1200};   ///< the resolution of the PDF's coordinate system in dpi
+    bool shareRepeatedSvgs{false};   ///< write SVGs that occur on several pages only once, as images (see PdfExporter)
+    int sharedSvgDpi{0};   ///< the resolution of shared SVGs; 0 = the PDF's resolution
+  };
+
+  /** \brief Writes report pages as vector graphics into a PDF file
+   *
+   * The page items are painted one by one in their stacking order. By default,
+   * all items, including SVGs, are written as vector graphics; SVGs that occur on
+   * several pages (logos, watermarks, ...) are thus written once per page.
+   *
+   * With PdfExportOptions::shareRepeatedSvgs, SVG items whose content (identified by
+   * ITEM_DATA__SVG_CONTENT_HASH) occurs on more than one page are painted from a
+   * single shared image per content and size instead; Qt's PDF engine stores such
+   * an image only once and references it from all pages. This makes files with
+   * complex repeated SVGs much smaller, but these SVGs are rasterized and are no
+   * longer vector graphics. Qt's PDF engine doesn't offer reusable vector forms
+   * (form XObjects), so there's no way to get both.
+   *
+   * By default, the shared images have the PDF's own resolution, so that they
+   * look the same as the vector version at the PDF's resolution. Images that
+   * would exceed MAX_SHARED_SVG_PIXELS (e.g., full-page watermarks at 1200 dpi)
+   * get a correspondingly lower resolution.
+   */
+  class PdfExporter
+  {
+  public:
+    /** \brief the max. number of pixels of a shared SVG image (64 MB in ARGB32) */
+    static constexpr int MAX_SHARED_SVG_PIXELS = 4096 * 4096;
+
+    PdfExporter(
+        const std::vector<QGraphicsScene*>& _pages,   ///< the pages to be exported
+        double _w,   ///< the page width in internal units
+        double _h   ///< the page height in internal units
+        );
+
+    /** \brief Writes all pages to a PDF file
+     *
+     * \returns false if the file couldn't be written
+     */
+    bool exportPdf(const QString& fileName, const PdfExportOptions& options);
+
+  protected:
+    void findRepeatedSvgs();
+    QImage getSharedSvgImage(QGraphicsItem* item, int dpi);
+
+    std::vector<QGraphicsScene*> pages;
+    double w;
+    double h;
+    QHash<QByteArray, int> svgPageCount;   // content hash --> number of pages with this content
+    QHash<QByteArray, QImage> sharedSvgImages;   // content hash + size --> image
+  };
+
+}
+
+#endif // PDFEXPORTER_H
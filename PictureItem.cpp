@@ -0,0 +1,90 @@
+/*
+ *    This is SimpleReportGenerator, a very basic report generator on top of Qt.
+ *    Copyright (C) 2014 - 2015  Volker Knollmann
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdexcept>
+
+#include <QPainter>
+
+#include "PictureItem.h"
+
+namespace SimpleReportLib {
+
+  PictureItem::PictureItem(std::shared_ptr<const QPicture> _pic, const QRectF& _rect)
+    :QGraphicsItem(), pic(_pic), rect(_rect)
+  {
+    if (pic == nullptr)
+    {
+      throw std::invalid_argument("Invalid parameters for PictureItem ctor!");
+    }
+  }
+
+  //----------------------------------------------------------------------------
+
+  QRectF PictureItem::boundingRect() const
+  {
+    return rect;
+  }
+
+  //----------------------------------------------------------------------------
+
+  void PictureItem::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget)
+  {
+    Q_UNUSED(option);
+    Q_UNUSED(widget);
+
+    // playing a picture isn't thread-safe (QPicture::play() seeks in the
+    // picture's internal buffer) and the shared picture might be painted
+    // by several render threads at once; so we never play the shared
+    // picture itself but a private copy of its data
+    QPicture privateCopy;
+    privateCopy.setData(pic->data(), pic->size());
+    painter->drawPicture(0, 0, privateCopy);
+  }
+
+  //----------------------------------------------------------------------------
+
+  std::shared_ptr<const QPicture> PictureItem::recordScene(QGraphicsScene* sc, const QRectF& rect)
+  {
+    auto result = std::make_shared<QPicture>();
+    if (sc == nullptr) return result;
+
+    QPainter painter{result.get()};
+    painter.setRenderHint(QPainter::Antialiasing);
+    sc->render(&painter, rect, rect, Qt::IgnoreAspectRatio);
+    painter.end();
+
+    return result;
+  }
+
+  //----------------------------------------------------------------------------
+
+  std::shared_ptr<const QPicture> PictureItem::deepCopy(const std::shared_ptr<const QPicture>& pic)
+  {
+    if (pic == nullptr) return nullptr;
+
+    // copying a QPicture only copies a reference to the
+    // same data; setData() creates an independent copy
+    auto result = std::make_shared<QPicture>();
+    result->setData(pic->data(), pic->size());
+
+    return result;
+  }
+
+  //----------------------------------------------------------------------------
+
+}
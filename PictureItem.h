@@ -0,0 +1,69 @@
+/*
+ *    This is SimpleReportGenerator, a very basic report generator on top of Qt.
+ *    Copyright (C) 2014 - 2015  Volker Knollmann
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PICTUREITEM_H
+#define PICTUREITEM_H
+
+#include <memory>
+
+#include <QGraphicsItem>
+#include <QGraphicsScene>
+#include <QPicture>
+
+namespace SimpleReportLib {
+
+  /** \brief A graphics item that replays a pre-recorded display list
+   *
+   * The picture is shared between all items that reference it, e.g., the
+   * master page content of all pages. The picture's coordinates are in
+   * internal units, relative to the page's top left corner.
+   *
+   * The shared picture is only read; each call to paint() replays a copy of
+   * its data, so that several threads can render pages with the same
+   * picture at the same time.
+   */
+  class PictureItem : public QGraphicsItem
+  {
+  public:
+    PictureItem(
+        std::shared_ptr<const QPicture> _pic,   ///< the content, must not be null
+        const QRectF& _rect   ///< the area that is covered by the content
+        );
+
+    virtual QRectF boundingRect() const override;
+    virtual void paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget) override;
+
+    inline std::shared_ptr<const QPicture> getPicture() const { return pic; }
+
+    /** \brief Records the content of a scene area into a new display list, 1:1 in scene coordinates */
+    static std::shared_ptr<const QPicture> recordScene(QGraphicsScene* sc, const QRectF& rect);
+
+    /** \brief Creates a deep copy of a picture that doesn't share any data with the original
+     *
+     * \returns nullptr if the original is null
+     */
+    static std::shared_ptr<const QPicture> deepCopy(const std::shared_ptr<const QPicture>& pic);
+
+  protected:
+    std::shared_ptr<const QPicture> pic;
+    QRectF rect;
+  };
+
+}
+
+#endif // PICTUREITEM_H
@@ -0,0 +1,163 @@
+/*
+ *    This is SimpleReportGenerator, a very basic report generator on top of Qt.
+ *    Copyright (C) 2014 - 2015  Volker Knollmann
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <future>
+#include <stdexcept>
+
+#include <QGraphicsScene>
+#include <QPainter>
+
+#include "PrintJob.h"
+
+namespace SimpleReportLib {
+
+  PrintJob::PrintJob(SimpleReportGenerator* _report, std::unique_ptr<QPrinter> _printer, int _firstPage, int _lastPage,
+                     PageTileCache* _sceneLockProvider, QObject* parent)
+    :QObject(parent), report(_report), printer(std::move(_printer)), firstPage(_firstPage), lastPage(_lastPage),
+      sceneLockProvider(_sceneLockProvider)
+  {
+    if ((report == nullptr) || (printer == nullptr) || (firstPage < 0) || (lastPage < firstPage) ||
+        (lastPage >= report->getPageCount()))
+    {
+      throw std::invalid_argument("Invalid parameters for PrintJob ctor!");
+    }
+
+    pageRect = QRectF{0, 0, report->getPageWidth() * ACCURACY_FAC, report->getPageHeight() * ACCURACY_FAC};
+  }
+
+  //----------------------------------------------------------------------------
+
+  PrintJob::~PrintJob()
+  {
+    cancel();
+    if (worker.joinable()) worker.join();
+  }
+
+  //----------------------------------------------------------------------------
+
+  void PrintJob::start()
+  {
+    if (worker.joinable()) return;
+
+    worker = std::thread([this]() { run(); });
+  }
+
+  //----------------------------------------------------------------------------
+
+  void PrintJob::cancel()
+  {
+    cancelRequested = true;
+  }
+
+  //----------------------------------------------------------------------------
+
+  void PrintJob::run()
+  {
+    // painting on a QPrinter is supported outside of the GUI thread
+    // as long as all painting happens in one thread
+    QPainter painter{printer.get()};
+    if (!(painter.isActive()))
+    {
+      emit finished(true);
+      return;
+    }
+
+    const int nPages = getPageCount();
+    std::future<std::unique_ptr<QPicture>> nextPage = std::async(std::launch::async, &PrintJob::recordPage, this, firstPage);
+
+    int donePages = 0;
+    for (int pg = firstPage; pg <= lastPage; ++pg)
+    {
+      std::unique_ptr<QPicture> curPage = nextPage.get();
+      if (cancelRequested) break;
+
+      // record the next page while the current one
+      // is streamed to the printer
+      if (pg < lastPage)
+      {
+        nextPage = std::async(std::launch::async, &PrintJob::recordPage, this, pg + 1);
+      }
+
+      if (curPage != nullptr) playPage(&painter, *curPage);
+      ++donePages;
+      emit progress(donePages, nPages);
+
+      if ((pg < lastPage) && !cancelRequested)
+      {
+        printer->newPage();
+      }
+    }
+
+    // wait for a page that might still be recorded
+    if (nextPage.valid()) nextPage.wait();
+
+    if (cancelRequested)
+    {
+      printer->abort();
+    }
+    painter.end();
+
+    emit finished(cancelRequested);
+  }
+
+  //----------------------------------------------------------------------------
+
+  std::unique_ptr<QPicture> PrintJob::recordPage(int pg)
+  {
+    if (cancelRequested) return nullptr;
+
+    std::unique_lock<std::mutex> sceneLock;
+    if (sceneLockProvider != nullptr) sceneLock = sceneLockProvider->lockScenes();
+
+    QGraphicsScene* scene = report->getPage(pg);
+    if (scene == nullptr) return nullptr;
+
+    // record the page 1:1 in internal units; the scaling
+    // to the printer's resolution happens during playback
+    auto pic = std::make_unique<QPicture>();
+    QPainter painter{pic.get()};
+    painter.setRenderHint(QPainter::Antialiasing);
+    scene->render(&painter, pageRect, pageRect, Qt::IgnoreAspectRatio);
+    painter.end();
+
+    return pic;
+  }
+
+  //----------------------------------------------------------------------------
+
+  void PrintJob::playPage(QPainter* painter, const QPicture& pic)
+  {
+    // fit the page into the printable area and center it,
+    // just like QGraphicsScene::render() would do
+    QRectF target = painter->viewport();
+    double scale = std::min(target.width() / pageRect.width(), target.height() / pageRect.height());
+    double dx = (target.width() - pageRect.width() * scale) / 2.0;
+    double dy = (target.height() - pageRect.height() * scale) / 2.0;
+
+    painter->save();
+    painter->setRenderHint(QPainter::Antialiasing);
+    painter->translate(target.left() + dx, target.top() + dy);
+    painter->scale(scale, scale);
+    painter->drawPicture(0, 0, pic);
+    painter->restore();
+  }
+
+  //----------------------------------------------------------------------------
+
+}
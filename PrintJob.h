@@ -0,0 +1,88 @@
+/*
+ *    This is SimpleReportGenerator, a very basic report generator on top of Qt.
+ *    Copyright (C) 2014 - 2015  Volker Knollmann
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PRINTJOB_H
+#define PRINTJOB_H
+
+#include <atomic>
+#include <memory>
+#include <thread>
+
+#include <QObject>
+#include <QPicture>
+#include <QPrinter>
+
+#include "SimpleReportGenerator.h"
+#include "PageTileCache.h"
+
+namespace SimpleReportLib {
+
+  /** \brief Prints a range of report pages on a background thread
+   *
+   * The pages are processed in a two-stage pipeline: while one page is
+   * streamed to the printer, the next page is already recorded into a
+   * display list (QPicture). Access to the scenes is serialized through
+   * the scene lock of a PageTileCache, if provided.
+   *
+   * progress() and finished() are emitted from the job's thread, so
+   * connections to GUI objects are queued.
+   */
+  class PrintJob : public QObject
+  {
+    Q_OBJECT
+
+  public:
+    PrintJob(SimpleReportGenerator* _report, std::unique_ptr<QPrinter> _printer, int _firstPage, int _lastPage,
+             PageTileCache* _sceneLockProvider = nullptr, QObject* parent = nullptr);
+
+    /** \brief Cancels the job (if still running) and waits for its thread */
+    virtual ~PrintJob();
+
+    /** \brief Starts printing; returns immediately */
+    void start();
+
+    inline bool isCancelled() const { return cancelRequested; }
+    inline int getPageCount() const { return lastPage - firstPage + 1; }
+
+  public slots:
+    /** \brief Asks the job to stop after the current page; returns immediately */
+    void cancel();
+
+  signals:
+    void progress(int donePages, int totalPages);
+    void finished(bool wasCancelled);
+
+  protected:
+    void run();
+    std::unique_ptr<QPicture> recordPage(int pg);
+    void playPage(QPainter* painter, const QPicture& pic);
+
+    SimpleReportGenerator* report;
+    std::unique_ptr<QPrinter> printer;
+    int firstPage;
+    int lastPage;
+    PageTileCache* sceneLockProvider;
+    QRectF pageRect;   // the scenes' dimensions in internal units
+
+    std::atomic<bool> cancelRequested{false};
+    std::thread worker;
+  };
+
+}
+
+#endif // PRINTJOB_H
@@ -0,0 +1,182 @@
+/*
+ *    This is SimpleReportGenerator, a very basic report generator on top of Qt.
+ *    Copyright (C) 2014 - 2015  Volker Knollmann
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <climits>
+
+#include <QByteArray>
+#include <QCoreApplication>
+#include <QDataStream>
+#include <QPainter>
+#include <QPicture>
+#include <QThread>
+
+#include "ReportArchive.h"
+#include "PictureItem.h"
+
+namespace SimpleReportLib {
+
+  constexpr quint32 ReportArchive::MAGIC;
+  constexpr quint32 ReportArchive::FORMAT_VERSION;
+
+  // the byte size of the fixed part of the header and of one page table entry
+  static constexpr qint64 HEADER_SIZE = 4 + 4 + 3 * 8 + 4 + 2 * 8;
+  static constexpr qint64 PAGE_TABLE_ENTRY_SIZE = 2 * 8;
+
+  bool ReportArchive::write(const QString& fileName, double w, double h, double margin, const std::vector<QGraphicsScene*>& pages, const ReportTextIndex& textIndex)
+  {
+    QFile f{fileName};
+    if (!(f.open(QIODevice::WriteOnly | QIODevice::Truncate))) return false;
+
+    QDataStream out{&f};
+    out.setVersion(QDataStream::Qt_5_6);
+
+    // the header and a placeholder for the page table;
+    // the offsets are filled in at the end
+    const quint32 nPages = static_cast<quint32>(pages.size());
+    out << MAGIC << FORMAT_VERSION << w << h << margin << nPages << quint64{0} << quint64{0};
+    for (quint32 i = 0; i < nPages; ++i) out << quint64{0} << quint64{0};
+
+    // the pages, recorded 1:1 in internal units
+    QRectF pageRect{0, 0, w, h};
+    std::vector<BlobRef> pageTable;
+    pageTable.reserve(nPages);
+    for (QGraphicsScene* sc : pages)
+    {
+      QPicture pic;
+      if (sc != nullptr)
+      {
+        QPainter painter{&pic};
+        painter.setRenderHint(QPainter::Antialiasing);
+        sc->render(&painter, pageRect, pageRect, Qt::IgnoreAspectRatio);
+        painter.end();
+      }
+
+      BlobRef ref{static_cast<quint64>(f.pos()), pic.size()};
+      out.writeRawData(pic.data(), static_cast<int>(pic.size()));
+      pageTable.push_back(ref);
+    }
+
+    // the text index
+    QByteArray idxData;
+    {
+      QDataStream idxOut{&idxData, QIODevice::WriteOnly};
+      idxOut.setVersion(QDataStream::Qt_5_6);
+      textIndex.save(idxOut);
+    }
+    BlobRef idxRef{static_cast<quint64>(f.pos()), static_cast<quint64>(idxData.size())};
+    out.writeRawData(idxData.constData(), idxData.size());
+
+    // patch the offsets
+    f.seek(HEADER_SIZE - 2 * 8);
+    out << idxRef.offset << idxRef.length;
+    for (const BlobRef& ref : pageTable) out << ref.offset << ref.length;
+
+    return (out.status() == QDataStream::Ok);
+  }
+
+  //----------------------------------------------------------------------------
+
+  std::unique_ptr<ReportArchive> ReportArchive::open(const QString& fileName)
+  {
+    std::unique_ptr<ReportArchive> ar{new ReportArchive()};
+    ar->file.setFileName(fileName);
+    if (!(ar->file.open(QIODevice::ReadOnly))) return nullptr;
+
+    ar->dataSize = ar->file.size();
+    if (ar->dataSize < HEADER_SIZE) return nullptr;
+
+    ar->data = ar->file.map(0, ar->dataSize);
+    if (ar->data == nullptr) return nullptr;
+
+    // parse the header without copying the mapped data
+    QByteArray raw = QByteArray::fromRawData(reinterpret_cast<const char*>(ar->data), static_cast<int>(std::min<qint64>(ar->dataSize, INT_MAX)));
+    QDataStream in{raw};
+    in.setVersion(QDataStream::Qt_5_6);
+
+    quint32 magic;
+    quint32 version;
+    quint32 nPages;
+    in >> magic >> version >> ar->w >> ar->h >> ar->margin >> nPages >> ar->textIndexRef.offset >> ar->textIndexRef.length;
+    if ((magic != MAGIC) || (version != FORMAT_VERSION) || (in.status() != QDataStream::Ok)) return nullptr;
+    if ((ar->w <= 0) || (ar->h <= 0) || (ar->margin < 0)) return nullptr;
+    if ((HEADER_SIZE + nPages * PAGE_TABLE_ENTRY_SIZE) > ar->dataSize) return nullptr;
+
+    // read and validate the page table
+    auto isValidRef = [&ar](const BlobRef& ref) {
+      return ((ref.offset <= static_cast<quint64>(ar->dataSize)) && (ref.length <= (static_cast<quint64>(ar->dataSize) - ref.offset)));
+    };
+    ar->pageTable.resize(nPages);
+    for (BlobRef& ref : ar->pageTable)
+    {
+      in >> ref.offset >> ref.length;
+      if (!(isValidRef(ref))) return nullptr;
+    }
+    if (!(isValidRef(ar->textIndexRef)) || (in.status() != QDataStream::Ok)) return nullptr;
+
+    return ar;
+  }
+
+  //----------------------------------------------------------------------------
+
+  ReportArchive::~ReportArchive()
+  {
+    if (data != nullptr) file.unmap(const_cast<uchar*>(data));
+  }
+
+  //----------------------------------------------------------------------------
+
+  std::unique_ptr<QGraphicsScene> ReportArchive::materializePage(int idxPage) const
+  {
+    if ((idxPage < 0) || (idxPage >= getPageCount())) return nullptr;
+
+    const BlobRef& ref = pageTable[idxPage];
+    auto pic = std::make_shared<QPicture>();
+    if (ref.length > 0)
+    {
+      pic->setData(reinterpret_cast<const char*>(data + ref.offset), static_cast<uint>(ref.length));
+    }
+
+    auto scene = std::make_unique<QGraphicsScene>(0, 0, w, h);
+    scene->addItem(new PictureItem(pic, QRectF{0, 0, w, h}));
+
+    // pages might be materialized on a worker thread, but
+    // the scene has to live in the GUI thread like all other pages
+    QCoreApplication* app = QCoreApplication::instance();
+    if ((app != nullptr) && (scene->thread() != app->thread()))
+    {
+      scene->moveToThread(app->thread());
+    }
+
+    return scene;
+  }
+
+  //----------------------------------------------------------------------------
+
+  bool ReportArchive::loadTextIndex(ReportTextIndex& idx) const
+  {
+    QByteArray raw = QByteArray::fromRawData(reinterpret_cast<const char*>(data + textIndexRef.offset), static_cast<int>(textIndexRef.length));
+    QDataStream in{raw};
+    in.setVersion(QDataStream::Qt_5_6);
+
+    return idx.load(in);
+  }
+
+  //----------------------------------------------------------------------------
+
+}
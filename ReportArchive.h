@@ -0,0 +1,108 @@
+/*
+ *    This is SimpleReportGenerator, a very basic report generator on top of Qt.
+ *    Copyright (C) 2014 - 2015  Volker Knollmann
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef REPORTARCHIVE_H
+#define REPORTARCHIVE_H
+
+#include <memory>
+#include <vector>
+
+#include <QFile>
+#include <QGraphicsScene>
+#include <QString>
+
+#include "ReportTextIndex.h"
+
+namespace SimpleReportLib {
+
+  /** \brief A binary file with laid-out report pages that is accessed through memory mapping
+   *
+   * File layout (QDataStream encoding):
+   *   - header: magic, format version, page width / height / margin (internal units),
+   *     page count, offset and length of the text index
+   *   - page table: offset and length of each page's data
+   *   - the page data, each page as a serialized QPicture (display list including
+   *     fonts, text, paths and rendered SVGs)
+   *   - the text index (all text runs with their page and bounding box)
+   *
+   * Opening an archive only maps the file and reads the header and the page table;
+   * the pages are only decoded when they're requested.
+   */
+  class ReportArchive
+  {
+  public:
+    static constexpr quint32 MAGIC = 0x53524741;   // "SRGA"
+    static constexpr quint32 FORMAT_VERSION = 1;
+
+    /** \brief Writes pages to a new archive file; all sizes in internal units
+     *
+     * \returns false if the file couldn't be written
+     */
+    static bool write(
+        const QString& fileName,   ///< the name of the file to be created / overwritten
+        double w,   ///< the page width in internal units
+        double h,   ///< the page height in internal units
+        double margin,   ///< the page margin in internal units
+        const std::vector<QGraphicsScene*>& pages,   ///< the pages to be stored
+        const ReportTextIndex& textIndex   ///< the report's text runs
+        );
+
+    /** \brief Maps an existing archive file into memory
+     *
+     * \returns nullptr if the file can't be mapped or is not a valid archive
+     */
+    static std::unique_ptr<ReportArchive> open(const QString& fileName);
+
+    virtual ~ReportArchive();
+
+    inline int getPageCount() const { return static_cast<int>(pageTable.size()); }
+    inline double getPageWidth__internalUnits() const { return w; }
+    inline double getPageHeight__internalUnits() const { return h; }
+    inline double getMargin__internalUnits() const { return margin; }
+
+    /** \brief Decodes a single page into a new scene; can be called from any thread
+     *
+     * \returns nullptr for invalid page indices
+     */
+    std::unique_ptr<QGraphicsScene> materializePage(int idxPage) const;
+
+    /** \brief Decodes the stored text runs into a text index */
+    bool loadTextIndex(ReportTextIndex& idx) const;
+
+  protected:
+    struct BlobRef
+    {
+      quint64 offset;
+      quint64 length;
+    };
+
+    ReportArchive() = default;
+
+    QFile file;
+    const uchar* data{nullptr};   // the memory mapped file content
+    qint64 dataSize{0};
+    double w{0};
+    double h{0};
+    double margin{0};
+    std::vector<BlobRef> pageTable;
+    BlobRef textIndexRef{0, 0};
+  };
+
+}
+
+#endif // REPORTARCHIVE_H
@@ -0,0 +1,148 @@
+/*
+ *    This is SimpleReportGenerator, a very basic report generator on top of Qt.
+ *    Copyright (C) 2014 - 2015  Volker Knollmann
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+
+#include "ReportBatchRunner.h"
+
+using namespace std;
+
+namespace SimpleReportLib {
+
+  ReportBatchRunner::ReportBatchRunner(double _w, double _h, double _margin)
+    :w(_w), h(_h), margin(_margin), textMetrics(make_shared<TextMetricsCache>())
+  {
+    // fail early and not once per record
+    if ((w <= 0) || (h <= 0) || ((2 * margin) >= w) || ((2 * margin) >= h))
+    {
+      throw std::invalid_argument("Invalid parameters for ReportBatchRunner ctor!");
+    }
+  }
+
+  //----------------------------------------------------------------------------
+
+  BatchRunStats ReportBatchRunner::run(const QVariantList& records, const ReportBuilder& builder, const ReportSink& sink, int nThreads)
+  {
+    BatchRunStats stats;
+    if (records.isEmpty() || !builder || !sink) return stats;
+
+    auto tStart = chrono::steady_clock::now();
+
+    if (nThreads <= 0) nThreads = max<int>(1, thread::hardware_concurrency());
+    nThreads = min(nThreads, records.size());
+
+    // distribute the records in contiguous blocks
+    queues.clear();
+    for (int i = 0; i < nThreads; ++i) queues.push_back(make_unique<WorkQueue>());
+    for (int idx = 0; idx < records.size(); ++idx)
+    {
+      queues[(static_cast<long>(idx) * nThreads) / records.size()]->jobs.push_back(idx);
+    }
+    finishedReports = 0;
+    failedReports = 0;
+
+    vector<thread> workers;
+    for (int i = 0; i < nThreads; ++i)
+    {
+      workers.emplace_back(&ReportBatchRunner::workerLoop, this, i, std::cref(records), std::cref(builder), std::cref(sink));
+    }
+    for (thread& t : workers) t.join();
+    queues.clear();
+
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - tStart;
+    stats.finishedReports = finishedReports;
+    stats.failedReports = failedReports;
+    stats.elapsed__s = elapsed.count();
+    if (stats.elapsed__s > 0) stats.reportsPerSecond = finishedReports / stats.elapsed__s;
+
+    return stats;
+  }
+
+  //----------------------------------------------------------------------------
+
+  void ReportBatchRunner::workerLoop(int idxWorker, const QVariantList& records, const ReportBuilder& builder, const ReportSink& sink)
+  {
+    while (true)
+    {
+      int idxRecord = takeJob(idxWorker);
+      if (idxRecord < 0) return;   // no new jobs are added during a run, so we're done
+
+      bool isOkay = true;
+      try
+      {
+        auto report = (prototype != nullptr) ? prototype->cloneConfiguration() : make_unique<SimpleReportGenerator>(w, h, margin);
+        report->setTextMetricsCache(textMetrics);
+        builder(*report, records.at(idxRecord));
+        sink(std::move(report), idxRecord);
+      }
+      catch (...)
+      {
+        // the builder and the sink are user code that might
+        // throw anything; the other reports are not affected
+        isOkay = false;
+      }
+
+      lock_guard<mutex> lock{statsMutex};
+      if (isOkay)
+      {
+        ++finishedReports;
+      } else {
+        ++failedReports;
+      }
+    }
+  }
+
+  //----------------------------------------------------------------------------
+
+  int ReportBatchRunner::takeJob(int idxWorker)
+  {
+    // own jobs are taken from the front...
+    {
+      WorkQueue& q = *(queues[idxWorker]);
+      lock_guard<mutex> lock{q.mutex};
+      if (!(q.jobs.empty()))
+      {
+        int idx = q.jobs.front();
+        q.jobs.pop_front();
+        return idx;
+      }
+    }
+
+    // ... and jobs of other threads from the back
+    const int nQueues = queues.size();
+    for (int i = 1; i < nQueues; ++i)
+    {
+      WorkQueue& q = *(queues[(idxWorker + i) % nQueues]);
+      lock_guard<mutex> lock{q.mutex};
+      if (!(q.jobs.empty()))
+      {
+        int idx = q.jobs.back();
+        q.jobs.pop_back();
+        return idx;
+      }
+    }
+
+    return -1;
+  }
+
+  //----------------------------------------------------------------------------
+
+}
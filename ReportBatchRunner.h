@@ -0,0 +1,124 @@
+/*
+ *    This is SimpleReportGenerator, a very basic report generator on top of Qt.
+ *    Copyright (C) 2014 - 2015  Volker Knollmann
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef REPORTBATCHRUNNER_H
+#define REPORTBATCHRUNNER_H
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <QVariant>
+#include <QVariantList>
+
+#include "SimpleReportGenerator.h"
+#include "TextMetricsCache.h"
+
+namespace SimpleReportLib {
+
+  /** \brief Fills a new report with the data of one record */
+  using ReportBuilder = std::function<void(SimpleReportGenerator& report, const QVariant& record)>;
+
+  /** \brief Receives a finished report, e.g. for exporting it; called on a worker thread */
+  using ReportSink = std::function<void(std::unique_ptr<SimpleReportGenerator> report, int idxRecord)>;
+
+  /** \brief The result of a batch run
+   */
+  struct BatchRunStats
+  {
+    int finishedReports{0};
+    int failedReports{0};   // reports whose builder or sink threw an exception (of any type)
+    double elapsed__s{0.0};
+    double reportsPerSecond{0.0};
+  };
+
+  /** \brief Generates one report per data record, using a pool of threads
+   *
+   * Each thread starts with a contiguous block of records. A thread that
+   * has run out of records steals records from the end of the other threads'
+   * blocks, so that the load stays balanced even if some reports take much
+   * longer than others.
+   *
+   * All reports share one text metrics cache, so that common texts are only
+   * measured once per batch; fonts are cached per thread anyway. Everything
+   * else (styles, pages, SVG renderers) is owned by each report because Qt's
+   * scene and SVG objects must not be used by several threads at once.
+   *
+   * The builder and the sink are called on the worker threads, so they must
+   * be thread-safe. Each report is handed to the sink as soon as it is
+   * complete; its scenes belong to the worker thread, so the sink should
+   * export it right away instead of passing it to another thread.
+   */
+  class ReportBatchRunner
+  {
+  public:
+    ReportBatchRunner(
+        double _w,   ///< the page width of all reports in mm
+        double _h,   ///< the page height of all reports in mm
+        double _margin   ///< the page margin of all reports in mm
+        );
+
+    /** \brief Generates the reports for all records; blocks until all reports are done
+     *
+     * \returns statistics about the run
+     */
+    BatchRunStats run(
+        const QVariantList& records,   ///< the data for the reports, one record per report
+        const ReportBuilder& builder,   ///< fills a report with the data of a record
+        const ReportSink& sink,   ///< receives the finished reports
+        int nThreads = 0   ///< the number of worker threads; 0 = number of cores
+        );
+
+    /** \brief Sets a configured generator as the starting point for all reports
+     *
+     * Each report starts as a clone of the prototype's configuration
+     * (see SimpleReportGenerator::cloneConfiguration()), including its page size.
+     * The prototype is only read during run(); it must not be modified meanwhile.
+     */
+    inline void setPrototype(const SimpleReportGenerator* _prototype) { prototype = _prototype; }
+
+    inline std::shared_ptr<TextMetricsCache> getTextMetricsCache() const { return textMetrics; }
+
+  protected:
+    struct WorkQueue
+    {
+      std::mutex mutex;   // protects the jobs
+      std::deque<int> jobs;   // record indices
+    };
+
+    void workerLoop(int idxWorker, const QVariantList& records, const ReportBuilder& builder, const ReportSink& sink);
+    int takeJob(int idxWorker);
+
+    double w;
+    double h;
+    double margin;
+    const SimpleReportGenerator* prototype{nullptr};
+    std::shared_ptr<TextMetricsCache> textMetrics;
+
+    // the state of a running batch
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+    std::mutex statsMutex;   // protects the counters
+    int finishedReports{0};
+    int failedReports{0};
+  };
+
+}
+
+#endif // REPORTBATCHRUNNER_H
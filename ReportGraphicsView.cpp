@@ -16,22 +16,34 @@
  *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <cmath>
+
 #include <QGraphicsView>
+#include <QPainter>
+
 #include "ReportGraphicsView.h"
+#include "PageTileCache.h"
+
+using namespace SimpleReportLib;
+
+constexpr double ReportGraphicsView::PAGE_GAP__MM;
+constexpr int ReportGraphicsView::RETAINED_PAGES;
+constexpr int ReportGraphicsView::ZOOM_FRAME_INTERVAL__MS;
+constexpr int ReportGraphicsView::ZOOM_SETTLE_DELAY__MS;
 
 
 ReportGraphicsView::ReportGraphicsView(QWidget* parent)
-  :QGraphicsView(parent), zoomPercent(100)
+  :QGraphicsView(parent), zoomPercent(100), pageScene(new QGraphicsScene(this))
 {
-
+  initZoomTimers();
 }
 
 //---------------------------------------------------------------------------
 
 ReportGraphicsView::ReportGraphicsView(QGraphicsScene* scene, QWidget* parent)
-  :QGraphicsView(scene, parent), zoomPercent(100)
+  :QGraphicsView(scene, parent), zoomPercent(100), pageScene(new QGraphicsScene(this))
 {
-
+  initZoomTimers();
 }
 
 //---------------------------------------------------------------------------
@@ -41,11 +53,33 @@ void ReportGraphicsView::setZoomFactor(int _zoomPercent)
   // ensure valid values
   if (_zoomPercent <= 0) return;
 
-  // store the new zoom factor and repaint the widget
+  // store the new zoom factor; the view's transformation
+  // is updated with the next frame, so that a burst of
+  // wheel events or slider moves only leads to a single
+  // update per frame
   zoomPercent = _zoomPercent;
+  if (!(zoomTimer.isActive())) zoomTimer.start();
+
+  // during the zoom gesture we show the already rendered
+  // tiles in scaled form; the full-quality tiles are requested
+  // once the zoom has settled
+  if (!isZooming)
+  {
+    isZooming = true;
+    zoomBaseScaleKey = getCurrentScaleKey();
+  }
+  settleTimer.start();
+
+  // tell the world that the view's zoom has changed
+  emit viewZoomFactorChanged(zoomPercent);
+}
+
+//---------------------------------------------------------------------------
 
-  // maximize the scene on the screen
-  QRectF sceneExtends = sceneRect();
+void ReportGraphicsView::applyZoom()
+{
+  // maximize the scene (or a single page in continuous mode) on the screen
+  QRectF sceneExtends = getFitRect();
   double scaleX = width() / sceneExtends.width();
   double scaleY = height() / sceneExtends.height();
   double viewScale = std::min(scaleX, scaleY);
@@ -58,11 +92,38 @@ void ReportGraphicsView::setZoomFactor(int _zoomPercent)
   resetTransform();
   scale(viewScale, viewScale);
 
-  // tell the world that the view's zoom has changed
-  emit viewZoomFactorChanged(zoomPercent);
+  // the zoom changes the set of visible pages
+  if (continuousMode) updateVisiblePages();
 
-  // repaint
-  this->repaint();
+  viewport()->update();
+}
+
+//---------------------------------------------------------------------------
+
+void ReportGraphicsView::onZoomSettled()
+{
+  // apply a zoom that is still pending before
+  // requesting tiles for the final scale
+  if (zoomTimer.isActive())
+  {
+    zoomTimer.stop();
+    applyZoom();
+  }
+
+  isZooming = false;
+
+  // tiles requested for intermediate scales are obsolete
+  if (tileCache != nullptr) tileCache->cancelPending();
+
+  // trigger the prefetching of the adjacent pages for the final scale
+  if (continuousMode)
+  {
+    firstVisiblePage = -1;
+    lastVisiblePage = -1;
+    updateVisiblePages();
+  }
+
+  viewport()->update();
 }
 
 //---------------------------------------------------------------------------
@@ -90,7 +151,24 @@ void ReportGraphicsView::recalcZoom()
   // the scaling factor can't be established. If then subsequently
   // a report is assigned, the scaling factors need to be recalculated
   // based on the new report's dimensions
-  setZoomFactor(zoomPercent);
+  //
+  // this is not a zoom gesture, so we apply the
+  // new transformation immediately
+  zoomTimer.stop();
+  applyZoom();
+}
+
+//---------------------------------------------------------------------------
+
+void ReportGraphicsView::initZoomTimers()
+{
+  zoomTimer.setSingleShot(true);
+  zoomTimer.setInterval(ZOOM_FRAME_INTERVAL__MS);
+  connect(&zoomTimer, SIGNAL(timeout()), this, SLOT(applyZoom()));
+
+  settleTimer.setSingleShot(true);
+  settleTimer.setInterval(ZOOM_SETTLE_DELAY__MS);
+  connect(&settleTimer, SIGNAL(timeout()), this, SLOT(onZoomSettled()));
 }
 
 //---------------------------------------------------------------------------
@@ -123,6 +201,318 @@ void ReportGraphicsView::wheelEvent(QWheelEvent* ev)
 
 //---------------------------------------------------------------------------
 
+void ReportGraphicsView::setTileCache(PageTileCache* cache)
+{
+  if (tileCache != nullptr)
+  {
+    disconnect(tileCache, nullptr, this, nullptr);
+  }
+
+  tileCache = cache;
+  pageCount = 0;
+  cachedPage = -1;
+
+  if (tileCache != nullptr)
+  {
+    connect(tileCache, SIGNAL(tileReady(int)), this, SLOT(onTileReady(int)), Qt::QueuedConnection);
+  }
+}
+
+//---------------------------------------------------------------------------
+
+void ReportGraphicsView::setCachedPages(int nPages, const QSizeF& _pageSize)
+{
+  if (tileCache == nullptr) return;
+
+  pageCount = std::max(0, nPages);
+  pageSize = _pageSize;
+  if (cachedPage >= pageCount) cachedPage = pageCount - 1;
+  firstVisiblePage = -1;
+  lastVisiblePage = -1;
+  centerPage = -1;
+
+  updateSceneLayout();
+}
+
+//---------------------------------------------------------------------------
+
+void ReportGraphicsView::setContinuousMode(bool isContinuous)
+{
+  if (isContinuous == continuousMode) return;
+
+  int pg = continuousMode ? centerPage : cachedPage;
+  continuousMode = isContinuous;
+  firstVisiblePage = -1;
+  lastVisiblePage = -1;
+  centerPage = -1;
+
+  updateSceneLayout();
+  if (pg >= 0) showCachedPage(pg);
+}
+
+//---------------------------------------------------------------------------
+
+bool ReportGraphicsView::isContinuousMode() const
+{
+  return continuousMode;
+}
+
+//---------------------------------------------------------------------------
+
+void ReportGraphicsView::showCachedPage(int pg)
+{
+  if ((tileCache == nullptr) || (pg < 0) || (pg >= pageCount)) return;
+
+  if (continuousMode)
+  {
+    // scroll the top of the page to the top of the viewport
+    QRectF visibleArea = mapToScene(viewport()->rect()).boundingRect();
+    QRectF pageRect = getPageRect(pg);
+    double gap = PAGE_GAP__MM * SimpleReportLib::ACCURACY_FAC;
+    centerOn(QPointF{visibleArea.center().x(), pageRect.top() - gap / 2.0 + visibleArea.height() / 2.0});
+    updateVisiblePages();
+    return;
+  }
+
+  // tiles that have been requested for the old page are obsolete
+  if (pg != cachedPage) tileCache->cancelPending();
+
+  cachedPage = pg;
+  recalcZoom();
+  viewport()->update();
+}
+
+//---------------------------------------------------------------------------
+
+void ReportGraphicsView::prefetchPage(int pg)
+{
+  if ((tileCache == nullptr) || (pg < 0) || (pg >= pageCount)) return;
+
+  // we assume that the page will be viewed with the same
+  // horizontal scroll position and zoom level as the current page
+  QRectF visibleArea = mapToScene(viewport()->rect()).boundingRect();
+  QRectF region{visibleArea.left(), 0, visibleArea.width(), std::min(visibleArea.height(), pageSize.height())};
+  if (!continuousMode) region = visibleArea;
+  region = region.intersected(QRectF{QPointF{0, 0}, pageSize});
+
+  tileCache->requestRegion(pg, getCurrentScaleKey(), region, PageTileCache::PRIORITY::PREFETCH);
+}
+
+//---------------------------------------------------------------------------
+
+void ReportGraphicsView::onTileReady(int pg)
+{
+  // update() is coalesced by Qt, so bursts of finished
+  // tiles only lead to a single repaint
+  if (continuousMode)
+  {
+    if ((pg >= firstVisiblePage) && (pg <= lastVisiblePage)) viewport()->update();
+  } else {
+    if (pg == cachedPage) viewport()->update();
+  }
+}
+
+//---------------------------------------------------------------------------
+
+void ReportGraphicsView::drawBackground(QPainter* painter, const QRectF& rect)
+{
+  QGraphicsView::drawBackground(painter, rect);
+
+  if ((tileCache == nullptr) || (pageCount == 0) || (scene() != pageScene)) return;
+
+  // determine the pages that intersect with the exposed area
+  int firstPage = cachedPage;
+  int lastPage = cachedPage;
+  if (continuousMode)
+  {
+    double pitch = getPageRect(1).top();
+    firstPage = std::max(0, static_cast<int>(std::floor(rect.top() / pitch)));
+    lastPage = std::min(pageCount - 1, static_cast<int>(std::floor(rect.bottom() / pitch)));
+  }
+  if (firstPage < 0) return;
+
+  // during a zoom gesture, the tiles of the scale at the beginning
+  // of the gesture are stretched to the current scale and no new
+  // tiles are rendered
+  const bool useScaledTiles = (isZooming && (zoomBaseScaleKey > 0));
+  const int scaleKey = useScaledTiles ? zoomBaseScaleKey : getCurrentScaleKey();
+  const double tileExtent = PageTileCache::TILE_SIZE / PageTileCache::keyToScale(scaleKey);
+
+  painter->save();
+  painter->setRenderHint(QPainter::SmoothPixmapTransform, useScaledTiles);
+  for (int pg = firstPage; pg <= lastPage; ++pg)
+  {
+    QRectF pageRect = getPageRect(pg);
+    QRectF area = rect.intersected(pageRect);
+    if (area.isEmpty()) continue;
+
+    // a white page as placeholder for missing tiles
+    painter->fillRect(area, Qt::white);
+
+    // tile coordinates are relative to the page's top left corner
+    area.translate(-pageRect.topLeft());
+    const int tx0 = static_cast<int>(std::floor(area.left() / tileExtent));
+    const int ty0 = static_cast<int>(std::floor(area.top() / tileExtent));
+    const int tx1 = static_cast<int>(std::ceil(area.right() / tileExtent));
+    const int ty1 = static_cast<int>(std::ceil(area.bottom() / tileExtent));
+
+    // blit all cached tiles; missing tiles are queued for rendering
+    // and trigger a repaint as soon as they're available
+    painter->save();
+    painter->setClipRect(pageRect);
+    painter->translate(pageRect.topLeft());
+    for (int ty = ty0; ty < ty1; ++ty)
+    {
+      for (int tx = tx0; tx < tx1; ++tx)
+      {
+        PageTileKey key{pg, scaleKey, tx, ty};
+        QImage tile = useScaledTiles ? tileCache->peekTile(key) : tileCache->getTile(key, PageTileCache::PRIORITY::VISIBLE);
+        if (tile.isNull()) continue;
+        painter->drawImage(PageTileCache::tileRect(key), tile);
+      }
+    }
+    painter->restore();
+  }
+  painter->restore();
+}
+
+//---------------------------------------------------------------------------
+
+void ReportGraphicsView::setHighlight(int pg, const QRectF& box)
+{
+  highlightPage = pg;
+  highlightBox = box;
+
+  // the page is already shown (single page mode) or
+  // laid out (continuous mode), so we can scroll right away
+  if ((scene() == pageScene) && ((pg == cachedPage) || continuousMode))
+  {
+    ensureVisible(highlightBox.translated(getPageRect(pg).topLeft()));
+  }
+
+  viewport()->update();
+}
+
+//---------------------------------------------------------------------------
+
+void ReportGraphicsView::clearHighlight()
+{
+  if (highlightPage < 0) return;
+
+  highlightPage = -1;
+  viewport()->update();
+}
+
+//---------------------------------------------------------------------------
+
+void ReportGraphicsView::drawForeground(QPainter* painter, const QRectF& rect)
+{
+  QGraphicsView::drawForeground(painter, rect);
+
+  if ((highlightPage < 0) || (highlightPage >= pageCount) || (scene() != pageScene)) return;
+  if (!continuousMode && (highlightPage != cachedPage)) return;
+
+  QRectF box = highlightBox.translated(getPageRect(highlightPage).topLeft());
+  if (!(box.intersects(rect))) return;
+
+  painter->fillRect(box, QColor(255, 255, 0, 96));
+}
+
+//---------------------------------------------------------------------------
+
+void ReportGraphicsView::scrollContentsBy(int dx, int dy)
+{
+  QGraphicsView::scrollContentsBy(dx, dy);
+
+  if (continuousMode) updateVisiblePages();
+}
+
+//---------------------------------------------------------------------------
+
+int ReportGraphicsView::getCurrentScaleKey() const
+{
+  // tiles are rendered in device pixels
+  double scale = transform().m11() * devicePixelRatioF();
+  return PageTileCache::scaleToKey(scale);
+}
+
+//---------------------------------------------------------------------------
+
+QRectF ReportGraphicsView::getPageRect(int pg) const
+{
+  if (!continuousMode) return QRectF{QPointF{0, 0}, pageSize};
+
+  double gap = PAGE_GAP__MM * SimpleReportLib::ACCURACY_FAC;
+  return QRectF{QPointF{0, pg * (pageSize.height() + gap)}, pageSize};
+}
+
+//---------------------------------------------------------------------------
+
+QRectF ReportGraphicsView::getFitRect() const
+{
+  // "100 %" always means "one page fits on the screen"
+  if ((tileCache != nullptr) && (pageCount > 0)) return QRectF{QPointF{0, 0}, pageSize};
+
+  return sceneRect();
+}
+
+//---------------------------------------------------------------------------
+
+void ReportGraphicsView::updateSceneLayout()
+{
+  if (pageCount == 0) return;
+
+  // the view shows an empty scene with the dimensions of the page(s);
+  // the content is painted as background from the tile cache
+  QRectF newRect = getPageRect(0);
+  if (continuousMode) newRect = newRect.united(getPageRect(pageCount - 1));
+  pageScene->setSceneRect(newRect);
+  if (scene() != pageScene) setScene(pageScene);
+
+  recalcZoom();
+  viewport()->update();
+}
+
+//---------------------------------------------------------------------------
+
+void ReportGraphicsView::updateVisiblePages()
+{
+  if ((tileCache == nullptr) || (pageCount == 0)) return;
+
+  // the range of pages in the viewport
+  QRectF visibleArea = mapToScene(viewport()->rect()).boundingRect();
+  double pitch = getPageRect(1).top();
+  int first = qBound(0, static_cast<int>(std::floor(visibleArea.top() / pitch)), pageCount - 1);
+  int last = qBound(0, static_cast<int>(std::floor(visibleArea.bottom() / pitch)), pageCount - 1);
+  int center = qBound(0, static_cast<int>(std::floor(visibleArea.center().y() / pitch)), pageCount - 1);
+
+  if ((first != firstVisiblePage) || (last != lastVisiblePage))
+  {
+    firstVisiblePage = first;
+    lastVisiblePage = last;
+
+    // forget about everything that is far away from the viewport;
+    // requests for visible tiles are re-issued by the next repaint
+    tileCache->cancelPending();
+    tileCache->releasePagesOutside(first - RETAINED_PAGES, last + RETAINED_PAGES);
+
+    // no prefetching for intermediate scales of a zoom gesture
+    if (!isZooming)
+    {
+      prefetchPage(last + 1);
+      prefetchPage(first - 1);
+    }
+  }
+
+  if (center != centerPage)
+  {
+    centerPage = center;
+    emit visiblePageChanged(center);
+  }
+}
+
+//---------------------------------------------------------------------------
+
 //---------------------------------------------------------------------------
 
 
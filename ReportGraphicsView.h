@@ -22,7 +22,13 @@
 #include <QObject>
 #include <QWidget>
 #include <QGraphicsView>
+#include <QGraphicsScene>
 #include <QWheelEvent>
+#include <QTimer>
+
+namespace SimpleReportLib {
+  class PageTileCache;
+}
 
 class ReportGraphicsView : public QGraphicsView
 {
@@ -36,13 +42,80 @@ public:
   int getZoomFactor() const;
   void recalcZoom();
 
+  /** \brief Lets the view paint pages from pre-rendered tiles instead of a live scene
+   */
+  void setTileCache(SimpleReportLib::PageTileCache* cache);
+
+  /** \brief Defines the pages that are painted from the tile cache; the page size is in internal units
+   */
+  void setCachedPages(int nPages, const QSizeF& _pageSize);
+
+  /** \brief Switches between single page display and continuous scrolling through all pages
+   *
+   * While scrolling, only the tiles of the pages around the viewport are kept (see
+   * RETAINED_PAGES). The decoded scenes of the other pages are released, too, but only
+   * for loaded reports; the scenes of generated reports always stay in memory.
+   */
+  void setContinuousMode(bool isContinuous);
+  bool isContinuousMode() const;
+
+  /** \brief Shows a page from the tile cache; in continuous mode, this scrolls to the page
+   */
+  void showCachedPage(int pg);
+
+  /** \brief Queues the tiles of another page for the area that is currently visible
+   */
+  void prefetchPage(int pg);
+
+  /** \brief Highlights an area of a page (internal units) and scrolls it into view
+   */
+  void setHighlight(int pg, const QRectF& box);
+  void clearHighlight();
+
   virtual void wheelEvent(QWheelEvent* ev);
 
 signals:
   void viewZoomFactorChanged(int newZoomFactor);
+  void visiblePageChanged(int pg);   // continuous mode only: the page in the middle of the viewport
+
+protected slots:
+  void onTileReady(int pg);
+  void applyZoom();
+  void onZoomSettled();
 
 protected:
+  static constexpr double PAGE_GAP__MM = 5.0;   // continuous mode: vertical space between pages
+  static constexpr int RETAINED_PAGES = 2;   // continuous mode: tiles of this many pages around the visible ones are kept
+  static constexpr int ZOOM_FRAME_INTERVAL__MS = 16;   // zoom requests are applied at most once per frame
+  static constexpr int ZOOM_SETTLE_DELAY__MS = 200;   // time without zoom requests after which pages are rendered in full quality
+
+  void initZoomTimers();
+
+  virtual void drawBackground(QPainter* painter, const QRectF& rect) override;
+  virtual void drawForeground(QPainter* painter, const QRectF& rect) override;
+  virtual void scrollContentsBy(int dx, int dy) override;
+  int getCurrentScaleKey() const;
+  QRectF getPageRect(int pg) const;
+  QRectF getFitRect() const;
+  void updateSceneLayout();
+  void updateVisiblePages();
+
   int zoomPercent;
+  SimpleReportLib::PageTileCache* tileCache{nullptr};
+  QGraphicsScene* pageScene;   // empty placeholder with the dimensions of the page(s) when showing cached pages
+  int pageCount{0};
+  QSizeF pageSize;
+  bool continuousMode{false};
+  int cachedPage{-1};   // single page mode: the page that is shown
+  int firstVisiblePage{-1};
+  int lastVisiblePage{-1};
+  int centerPage{-1};
+  QTimer zoomTimer;
+  QTimer settleTimer;
+  bool isZooming{false};   // true during a zoom gesture, i.e. until the zoom has settled
+  int zoomBaseScaleKey{-1};   // the scale of the tiles that are shown (scaled) during a zoom gesture
+  int highlightPage{-1};
+  QRectF highlightBox;   // relative to the page's top left corner
 };
 
 #endif // REPORTGRAPHICSVIEW_H
@@ -0,0 +1,141 @@
+/*
+ *    This is SimpleReportGenerator, a very basic report generator on top of Qt.
+ *    Copyright (C) 2014 - 2015  Volker Knollmann
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdexcept>
+
+#include <QGraphicsScene>
+
+#include "ReportProducer.h"
+#include "PictureItem.h"
+
+namespace SimpleReportLib {
+
+  ReportProducer::ReportProducer(SimpleReportGenerator* _report, QObject* parent)
+    :QObject(parent), report(_report), recordedPages(std::make_shared<PicturePageList>()), ownerThread(thread())
+  {
+    if (report == nullptr)
+    {
+      throw std::invalid_argument("Invalid parameters for ReportProducer ctor!");
+    }
+
+    pageRect = QRectF{0, 0, report->getPageWidth() * ACCURACY_FAC, report->getPageHeight() * ACCURACY_FAC};
+    preview = std::make_unique<SimpleReportGenerator>(report->getPageWidth(), report->getPageHeight(), report->getMargin());
+
+    // the recorded pages travel from the worker thread
+    // to our own thread through the event queue
+    qRegisterMetaType<QPicture>();
+    connect(this, SIGNAL(pageRecorded(QPicture)), this, SLOT(onPageRecorded(QPicture)), Qt::QueuedConnection);
+  }
+
+  //----------------------------------------------------------------------------
+
+  ReportProducer::~ReportProducer()
+  {
+    cancel();
+    if (worker.joinable()) worker.join();
+  }
+
+  //----------------------------------------------------------------------------
+
+  void ReportProducer::start()
+  {
+    if (worker.joinable()) return;
+
+    worker = std::thread([this]() { run(); });
+  }
+
+  //----------------------------------------------------------------------------
+
+  void ReportProducer::cancel()
+  {
+    cancelRequested = true;
+  }
+
+  //----------------------------------------------------------------------------
+
+  void ReportProducer::run()
+  {
+    // an exception must not leave the thread because
+    // that would terminate the whole application
+    QString errMsg;
+    try
+    {
+      int nPublished = 0;
+      while (!cancelRequested)
+      {
+        // a page is complete as soon as the next page has been started
+        bool isComplete = !(report->layoutUntilPage(nPublished + 1));
+        int nFinished = report->getLaidOutPageCount();
+        if (!isComplete) --nFinished;
+
+        for (; (nPublished < nFinished) && !cancelRequested; ++nPublished) publishPage(nPublished);
+
+        if (isComplete) break;
+      }
+    }
+    catch (std::exception& ex)
+    {
+      errMsg = QString::fromStdString(ex.what());
+      if (errMsg.isEmpty()) errMsg = "Unknown layout error";
+    }
+    catch (...)
+    {
+      errMsg = "Unknown layout error";
+    }
+
+    // the scenes have been created by this thread; they have to be
+    // moved before the owner thread can take over the report. We can't
+    // do that earlier because later sections might still modify them
+    // (e.g., headers and footers)
+    for (int idx = 0; idx < report->getLaidOutPageCount(); ++idx)
+    {
+      report->getPage(idx)->moveToThread(ownerThread);
+    }
+
+    emit finished(cancelRequested, errMsg);
+  }
+
+  //----------------------------------------------------------------------------
+
+  void ReportProducer::publishPage(int idxPage)
+  {
+    QGraphicsScene* scene = report->getPage(idxPage);
+    if (scene == nullptr) return;
+
+    auto pic = PictureItem::recordScene(scene, pageRect);
+    emit pageRecorded(*pic);
+  }
+
+  //----------------------------------------------------------------------------
+
+  void ReportProducer::onPageRecorded(const QPicture& pic)
+  {
+    auto page = std::make_shared<const QPicture>(pic);
+    preview->appendPicturePage(page);
+
+    // readers may still use the old list
+    auto pages = std::make_shared<PicturePageList>(*recordedPages);
+    pages->push_back(page);
+    recordedPages = pages;
+
+    emit pagesAvailable(preview->getPageCount());
+  }
+
+  //----------------------------------------------------------------------------
+
+}
@@ -0,0 +1,114 @@
+/*
+ *    This is SimpleReportGenerator, a very basic report generator on top of Qt.
+ *    Copyright (C) 2014 - 2015  Volker Knollmann
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef REPORTPRODUCER_H
+#define REPORTPRODUCER_H
+
+#include <atomic>
+#include <memory>
+#include <thread>
+
+#include <QMetaType>
+#include <QObject>
+#include <QPicture>
+#include <QThread>
+
+#include "SimpleReportGenerator.h"
+#include "PageTileCache.h"
+
+Q_DECLARE_METATYPE(QPicture)
+
+namespace SimpleReportLib {
+
+  /** \brief Lays out a report on a background thread and publishes the finished pages
+   *
+   * The report's pending sections (see SimpleReportGenerator::addSection()) are
+   * executed on the producer's thread. Whenever a page is complete (i.e., the
+   * next page has been started) it is recorded into a display list and sent
+   * through a queued signal to the thread that owns the producer (usually the
+   * GUI thread). There, it is appended to a preview report that only consists
+   * of the recorded pages and that can be displayed while the layout continues.
+   *
+   * The preview is only modified in the producer's own thread. Threads that
+   * render the preview (e.g., a PageTileCache) should use getRecordedPages()
+   * instead of the preview's scenes; that list is immutable and replaced as a
+   * whole for each new page, so no lock is needed on either side.
+   *
+   * The report itself must not be accessed by anyone else until finished()
+   * has been emitted. After that, it belongs to the producer's thread again.
+   * Everything that sections add after a page has been published (e.g.,
+   * headers and footers) only shows up in the report, not in the preview.
+   *
+   * finished() is emitted from the worker thread, so connections to GUI
+   * objects are queued; it is delivered after the last pagesAvailable().
+   * If a section throws an exception, the layout stops and finished()
+   * carries the exception's message (a generic one for exceptions that
+   * aren't derived from std::exception); the report is incomplete then.
+   */
+  class ReportProducer : public QObject
+  {
+    Q_OBJECT
+
+  public:
+    ReportProducer(SimpleReportGenerator* _report, QObject* parent = nullptr);
+
+    /** \brief Cancels the layout (if still running) and waits for its thread
+     *
+     * A section that is currently executed is finished first.
+     */
+    virtual ~ReportProducer();
+
+    /** \brief Starts the layout; returns immediately */
+    void start();
+
+    inline bool isCancelled() const { return cancelRequested; }
+    inline SimpleReportGenerator* getReport() const { return report; }
+    inline SimpleReportGenerator* getPreview() const { return preview.get(); }
+
+    /** \returns the recorded pages of the preview; a snapshot that is never modified */
+    inline std::shared_ptr<const PicturePageList> getRecordedPages() const { return recordedPages; }
+
+  public slots:
+    /** \brief Asks the producer to stop after the current section; returns immediately */
+    void cancel();
+
+  signals:
+    void pagesAvailable(int nPages);
+    void finished(bool wasCancelled, const QString& errMsg);   ///< `errMsg` is empty if the layout succeeded
+    void pageRecorded(const QPicture& pic);
+
+  protected slots:
+    void onPageRecorded(const QPicture& pic);
+
+  protected:
+    void run();
+    void publishPage(int idxPage);
+
+    SimpleReportGenerator* report;
+    std::unique_ptr<SimpleReportGenerator> preview;
+    std::shared_ptr<const PicturePageList> recordedPages;
+    QThread* ownerThread;   // the thread that receives the pages and the report
+    QRectF pageRect;   // the scenes' dimensions in internal units
+
+    std::atomic<bool> cancelRequested{false};
+    std::thread worker;
+  };
+
+}
+
+#endif // REPORTPRODUCER_H
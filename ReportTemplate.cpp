@@ -0,0 +1,444 @@
+/*
+ *    This is SimpleReportGenerator, a very basic report generator on top of Qt.
+ *    Copyright (C) 2014 - 2015  Volker Knollmann
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdexcept>
+
+#include <QDir>
+#include <QFile>
+#include <QJsonArray>
+
+#include "ReportTemplate.h"
+#include "JsonReportBuilder.h"
+#include "TableWriter.h"
+
+namespace SimpleReportLib {
+
+  TextTemplate::TextTemplate(const QString& txt)
+  {
+    int pos = 0;
+    while (true)
+    {
+      int start = txt.indexOf("{{", pos);
+      int end = (start < 0) ? -1 : txt.indexOf("}}", start + 2);
+      if (end < 0)
+      {
+        literals.append(txt.mid(pos));
+        break;
+      }
+
+      literals.append(txt.mid(pos, start - pos));
+      fields.append(txt.mid(start + 2, end - start - 2).trimmed());
+      pos = end + 2;
+    }
+  }
+
+  //----------------------------------------------------------------------------
+
+  QString TextTemplate::render(const QVariantMap& data) const
+  {
+    if (fields.isEmpty()) return literals.value(0);
+
+    QString result = literals[0];
+    for (int i = 0; i < fields.size(); ++i)
+    {
+      result += data.value(fields[i]).toString();
+      result += literals[i + 1];
+    }
+
+    return result;
+  }
+
+  //----------------------------------------------------------------------------
+
+  ReportTemplate::ReportTemplate(const QJsonObject& description, const QString& _baseDir)
+    :baseDir(_baseDir), textMetrics(make_shared<TextMetricsCache>())
+  {
+    QJsonObject page = description.value("page").toObject();
+    prototype = make_unique<SimpleReportGenerator>(
+                  page.value("width").toDouble(210.0),
+                  page.value("height").toDouble(297.0),
+                  page.value("margin").toDouble(20.0));
+    prototype->setTextMetricsCache(textMetrics);
+
+    JsonReportBuilder::createStyles(*prototype, description.value("styles").toObject());
+
+    // header and footer fields with data have to be rendered for
+    // each report; static fields are set once in the prototype
+    QStringList hdr = JsonReportBuilder::toStringList(description.value("header").toArray());
+    QStringList ftr = JsonReportBuilder::toStringList(description.value("footer").toArray());
+    while (hdr.size() < 3) hdr.append(QString());
+    while (ftr.size() < 3) ftr.append(QString());
+    for (const QString& s : hdr.mid(0, 3) + ftr.mid(0, 3))
+    {
+      headerFooter.push_back(TextTemplate{s});
+      if (!(headerFooter.back().isStatic())) hasDataInHeaderFooter = true;
+    }
+    if (!hasDataInHeaderFooter)
+    {
+      prototype->setGlobalHeader(hdr[0], hdr[1], hdr[2]);
+      prototype->setGlobalFooter(ftr[0], ftr[1], ftr[2]);
+    }
+
+    // the background becomes the master page that is shared by all reports
+    prototype->beginMasterPage();
+    for (const QJsonValue& v : description.value("background").toArray())
+    {
+      drawBackgroundItem(v.toObject());
+    }
+
+    // starting a page finishes the master page and measures the
+    // header height into the shared cache; the page itself
+    // is not copied to the reports
+    prototype->startNextPage();
+
+    for (const QJsonValue& v : description.value("content").toArray())
+    {
+      compileItem(v.toObject());
+    }
+  }
+
+  //----------------------------------------------------------------------------
+
+  unique_ptr<ReportTemplate> ReportTemplate::fromFile(const QString& fileName, QString* errMsg)
+  {
+    auto builder = JsonReportBuilder::fromFile(fileName, errMsg);
+    if (builder == nullptr) return nullptr;
+
+    try
+    {
+      return make_unique<ReportTemplate>(builder->getDescription(), builder->getBaseDir());
+    }
+    catch (std::invalid_argument& ex)
+    {
+      if (errMsg != nullptr) *errMsg = fileName + ": " + QString::fromStdString(ex.what());
+    }
+
+    return nullptr;
+  }
+
+  //----------------------------------------------------------------------------
+
+  unique_ptr<SimpleReportGenerator> ReportTemplate::execute(const QVariantMap& data) const
+  {
+    auto report = prototype->cloneConfiguration();
+    layout(*report, data);
+
+    return report;
+  }
+
+  //----------------------------------------------------------------------------
+
+  void ReportTemplate::layout(SimpleReportGenerator& report, const QVariantMap& data) const
+  {
+    // resolve the style indices once per report instead of once per line
+    vector<TextStyle*> styles;
+    styles.reserve(styleNames.size());
+    for (const QString& name : styleNames)
+    {
+      styles.push_back(report.getTextStyle(name));
+    }
+
+    if (hasDataInHeaderFooter)
+    {
+      report.setGlobalHeader(headerFooter[0].render(data), headerFooter[1].render(data), headerFooter[2].render(data));
+      report.setGlobalFooter(headerFooter[3].render(data), headerFooter[4].render(data), headerFooter[5].render(data));
+    }
+
+    report.startNextPage();
+    for (const LayoutOp& op : ops)
+    {
+      executeOp(report, op, styles, data);
+    }
+
+    report.applyHeaderAndFooterOnAllPages();
+  }
+
+  //----------------------------------------------------------------------------
+
+  QStringList ReportTemplate::getFieldNames() const
+  {
+    QStringList result;
+    for (const TextTemplate& t : headerFooter) result.append(t.getFieldNames());
+    for (const LayoutOp& op : ops)
+    {
+      result.append(op.text.getFieldNames());
+      for (const TextTemplate& t : op.header) result.append(t.getFieldNames());
+      for (const auto& row : op.rows)
+      {
+        for (const TextTemplate& t : row) result.append(t.getFieldNames());
+      }
+      result.append(op.caption.getFieldNames());
+      if (!(op.rowsField.isEmpty())) result.append(op.rowsField);
+    }
+    result.removeDuplicates();
+
+    return result;
+  }
+
+  //----------------------------------------------------------------------------
+
+  void ReportTemplate::compileItem(const QJsonObject& item)
+  {
+    const QString type = item.value("type").toString();
+
+    LayoutOp op;
+    op.skipBefore = item.value("skipBefore").toDouble(0.0);
+    op.skipAfter = item.value("skipAfter").toDouble(0.0);
+
+    if (type == "text")
+    {
+      op.code = OpCode::Text;
+      op.idxStyle = resolveStyle(item.value("style").toString());
+
+      // one op per line; only the first line has the skip
+      // before and only the last line has the skip after
+      const QStringList lines = item.value("text").toString().split('\n');
+      for (int i = 0; i < lines.size(); ++i)
+      {
+        LayoutOp lineOp = op;
+        lineOp.text = TextTemplate{lines[i]};
+        if (i != 0) lineOp.skipBefore = 0.0;
+        if (i != (lines.size() - 1)) lineOp.skipAfter = 0.0;
+        ops.push_back(lineOp);
+      }
+      return;
+    }
+
+    if (type == "skip")
+    {
+      op.code = OpCode::Skip;
+      op.mm = item.value("mm").toDouble(0.0);
+      ops.push_back(op);
+      return;
+    }
+
+    if (type == "line")
+    {
+      op.code = OpCode::Line;
+      op.lineType = JsonReportBuilder::toLineType(item.value("width").toString("medium"));
+      ops.push_back(op);
+      return;
+    }
+
+    if (type == "pageBreak")
+    {
+      op.code = OpCode::PageBreak;
+      ops.push_back(op);
+      return;
+    }
+
+    if (type == "table")
+    {
+      compileTable(item);
+      return;
+    }
+
+    if (type == "svg")
+    {
+      op.code = OpCode::Svg;
+      op.svgData = readSvgFile(item.value("file").toString());
+      op.mm = item.value("width").toDouble(0.0);
+      op.align = item.value("align").toString("left");
+      ops.push_back(op);
+      return;
+    }
+
+    if (type == "chart")
+    {
+      throw std::invalid_argument("Charts are not supported in report templates");
+    }
+
+    throw std::invalid_argument("Invalid content type: " + type.toStdString());
+  }
+
+  //----------------------------------------------------------------------------
+
+  void ReportTemplate::compileTable(const QJsonObject& item)
+  {
+    LayoutOp op;
+    op.code = OpCode::Table;
+    op.tabs = JsonReportBuilder::toTabSet(item.value("tabs").toArray());
+
+    for (const QString& cell : JsonReportBuilder::toStringList(item.value("header").toArray()))
+    {
+      op.header.push_back(TextTemplate{cell});
+    }
+    for (const QJsonValue& row : item.value("rows").toArray())
+    {
+      vector<TextTemplate> cells;
+      for (const QString& cell : JsonReportBuilder::toStringList(row.toArray()))
+      {
+        cells.push_back(TextTemplate{cell});
+      }
+      op.rows.push_back(std::move(cells));
+    }
+    op.rowsField = item.value("rowsField").toString();
+
+    op.hasCaption = item.contains("continuationCaption");
+    op.caption = TextTemplate{item.value("continuationCaption").toString()};
+
+    ops.push_back(std::move(op));
+  }
+
+  //----------------------------------------------------------------------------
+
+  void ReportTemplate::drawBackgroundItem(const QJsonObject& item)
+  {
+    const QString type = item.value("type").toString();
+    const double x = item.value("x").toDouble(0.0);
+    const double y = item.value("y").toDouble(0.0);
+
+    if (type == "text")
+    {
+      const QString txt = item.value("text").toString();
+      if (!(TextTemplate{txt}.isStatic()))
+      {
+        throw std::invalid_argument("Placeholders are not allowed in the background: " + txt.toStdString());
+      }
+
+      const QString align = item.value("align").toString("left");
+      HOR_TXT_ALIGNMENT hAlign = LEFT;
+      if (align == "center") hAlign = CENTER;
+      if (align == "right") hAlign = RIGHT;
+
+      int idxStyle = resolveStyle(item.value("style").toString());
+      TextStyle* style = (idxStyle < 0) ? nullptr : prototype->getTextStyle(styleNames[idxStyle]);
+      prototype->drawText(x, y, txt, style, hAlign);
+      return;
+    }
+
+    if (type == "line")
+    {
+      prototype->drawLine(item.value("x0").toDouble(), item.value("y0").toDouble(),
+                          item.value("x1").toDouble(), item.value("y1").toDouble(),
+                          JsonReportBuilder::toLineType(item.value("width").toString("medium")));
+      return;
+    }
+
+    if (type == "svg")
+    {
+      const QString fileName = item.value("file").toString();
+      QRectF bb = prototype->addSVG_byData_setW(QPointF{x, y}, RECT_CORNER::TOP_LEFT, readSvgFile(fileName), item.value("width").toDouble(0.0));
+      if (bb.isEmpty())
+      {
+        throw std::invalid_argument("Invalid SVG data in " + fileName.toStdString());
+      }
+      return;
+    }
+
+    throw std::invalid_argument("Invalid background type: " + type.toStdString());
+  }
+
+  //----------------------------------------------------------------------------
+
+  int ReportTemplate::resolveStyle(const QString& styleName)
+  {
+    if (styleName.isEmpty()) return -1;
+
+    if (prototype->getTextStyle(styleName) == nullptr)
+    {
+      throw std::invalid_argument("Invalid style name: " + styleName.toStdString());
+    }
+
+    int idx = styleNames.indexOf(styleName);
+    if (idx < 0)
+    {
+      styleNames.append(styleName);
+      idx = styleNames.size() - 1;
+    }
+
+    return idx;
+  }
+
+  //----------------------------------------------------------------------------
+
+  string ReportTemplate::readSvgFile(const QString& fileName) const
+  {
+    QFile f{QDir{baseDir}.absoluteFilePath(fileName)};
+    if (!(f.open(QIODevice::ReadOnly)))
+    {
+      throw std::invalid_argument("Can't open SVG file " + fileName.toStdString());
+    }
+
+    return f.readAll().toStdString();
+  }
+
+  //----------------------------------------------------------------------------
+
+  void ReportTemplate::executeOp(SimpleReportGenerator& report, const LayoutOp& op, const vector<TextStyle*>& styles, const QVariantMap& data) const
+  {
+    switch (op.code)
+    {
+    case OpCode::Text:
+      report.writeLine(op.text.render(data), (op.idxStyle < 0) ? nullptr : styles[op.idxStyle], op.skipAfter, op.skipBefore);
+      return;
+
+    case OpCode::Skip:
+      report.skip(op.mm);
+      return;
+
+    case OpCode::Line:
+      report.addHorLine(op.lineType, op.skipAfter, op.skipBefore);
+      return;
+
+    case OpCode::PageBreak:
+      report.startNextPage();
+      return;
+
+    case OpCode::Table:
+    {
+      TabSet tabs{op.tabs};
+      TableWriter tw{tabs};
+
+      QStringList header;
+      for (const TextTemplate& t : op.header) header.append(t.render(data));
+      tw.setHeader(header);
+
+      for (const auto& row : op.rows)
+      {
+        QStringList cells;
+        for (const TextTemplate& t : row) cells.append(t.render(data));
+        tw.appendRow(cells);
+      }
+      if (!(op.rowsField.isEmpty()))
+      {
+        for (const QVariant& row : data.value(op.rowsField).toList())
+        {
+          QStringList cells;
+          for (const QVariant& cell : row.toList()) cells.append(cell.toString());
+          tw.appendRow(cells);
+        }
+      }
+
+      if (op.hasCaption) tw.setNextPageContinuationCaption(op.caption.render(data));
+
+      tw.write(&report);
+      return;
+    }
+
+    case OpCode::Svg:
+      report.skip(op.skipBefore);
+      JsonReportBuilder::writeSvg(report, op.svgData, op.mm, op.align);
+      report.skip(op.skipAfter);
+      return;
+    }
+  }
+
+  //----------------------------------------------------------------------------
+
+}
@@ -0,0 +1,177 @@
+/*
+ *    This is SimpleReportGenerator, a very basic report generator on top of Qt.
+ *    Copyright (C) 2014 - 2015  Volker Knollmann
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef REPORTTEMPLATE_H
+#define REPORTTEMPLATE_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <QJsonObject>
+#include <QString>
+#include <QStringList>
+#include <QVariantMap>
+
+#include "SimpleReportGenerator.h"
+#include "TabSet.h"
+#include "TextMetricsCache.h"
+
+namespace SimpleReportLib {
+
+  /** \brief A text with placeholders for data fields, e.g. "Dear {{name}},"
+   *
+   * The text is split into literal chunks and field names once, so that
+   * rendering it for a record doesn't require parsing.
+   */
+  class TextTemplate
+  {
+  public:
+    TextTemplate() = default;
+    explicit TextTemplate(const QString& txt);
+
+    /** \returns the text with all placeholders replaced by the record's values; unknown fields are empty */
+    QString render(const QVariantMap& data) const;
+
+    /** \returns `true` if the text doesn't contain any placeholders */
+    inline bool isStatic() const { return fields.isEmpty(); }
+
+    inline const QStringList& getFieldNames() const { return fields; }
+
+  protected:
+    QStringList literals;   // always one more than fields
+    QStringList fields;
+  };
+
+  /** \brief A report description that has been compiled into a reusable layout program
+   *
+   * The description uses the same format as JsonReportBuilder, with the following additions:
+   *
+   *   - all texts, table cells and header / footer fields may contain placeholders
+   *     like "{{name}}" that are replaced by the values of a data record
+   *   - a table may contain "rowsField": "positions" to append one row per element
+   *     of the record's list "positions"; each element is a list of cells
+   *   - "background": [item, ...] contains static items at absolute positions that
+   *     are identical on all pages and may not contain placeholders:
+   *
+   *     {"type": "text", "x": 20, "y": 10, "text": "...", "style": "...", "align": "left" | "center" | "right"}
+   *     {"type": "line", "x0": 20, "y0": 15, "x1": 190, "y1": 15, "width": "thin" | "medium" | "thick"}
+   *     {"type": "svg", "file": "logo.svg", "x": 150, "y": 5, "width": 40}
+   *
+   * Everything that doesn't depend on the data is done only once in the
+   * constructor: the description is parsed and validated, the page geometry and
+   * styles are applied to a prototype generator, style names are resolved to
+   * indices, tab sets and placeholders are pre-parsed, SVG files are read, the
+   * background is recorded as the master page and the header height is measured
+   * into a text metrics cache that is shared by all reports.
+   *
+   * Executing the template for a record thus only clones the prototype and lays
+   * out the content items. The template is immutable after construction and
+   * each report gets its own copy of the recorded background, so several
+   * threads can execute the template and render the reports at the same time.
+   *
+   * Charts are not supported in templates.
+   */
+  class ReportTemplate
+  {
+  public:
+    /** \brief Compiles a report description
+     *
+     * Throws std::invalid_argument if the description contains invalid items.
+     */
+    ReportTemplate(
+        const QJsonObject& description,   ///< the report description
+        const QString& baseDir = QString()   ///< the directory for relative file names
+        );
+
+    /** \brief Reads and compiles a description from a file
+     *
+     * \returns nullptr if the file can't be read or the description is invalid
+     */
+    static std::unique_ptr<ReportTemplate> fromFile(
+        const QString& fileName,   ///< the name of the JSON file
+        QString* errMsg = nullptr   ///< receives a description of the problem, if any
+        );
+
+    /** \brief Creates a new report for a data record */
+    std::unique_ptr<SimpleReportGenerator> execute(const QVariantMap& data) const;
+
+    /** \brief Lays out the content for a data record in a report that has been cloned from the prototype
+     *
+     * Useful together with ReportBatchRunner::setPrototype().
+     */
+    void layout(
+        SimpleReportGenerator& report,   ///< a clone of getPrototype() without any pages
+        const QVariantMap& data   ///< the data record
+        ) const;
+
+    /** \returns the configured generator that all reports are cloned from */
+    inline const SimpleReportGenerator* getPrototype() const { return prototype.get(); }
+
+    /** \returns the names of all data fields that are used by the template */
+    QStringList getFieldNames() const;
+
+  protected:
+    enum class OpCode
+    {
+      Text,
+      Skip,
+      Line,
+      PageBreak,
+      Table,
+      Svg
+    };
+
+    struct LayoutOp
+    {
+      OpCode code;
+      double skipBefore{0.0};
+      double skipAfter{0.0};
+      double mm{0.0};   // the skip for Skip, the width for Svg
+      TextTemplate text;   // the line for Text
+      int idxStyle{-1};   // index in styleNames, -1 = root style
+      LINE_TYPE lineType{MED};
+      TabSet tabs;
+      std::vector<TextTemplate> header;
+      std::vector<std::vector<TextTemplate>> rows;
+      QString rowsField;
+      bool hasCaption{false};
+      TextTemplate caption;
+      std::string svgData;
+      QString align;
+    };
+
+    void compileItem(const QJsonObject& item);
+    void compileTable(const QJsonObject& item);
+    void drawBackgroundItem(const QJsonObject& item);
+    int resolveStyle(const QString& styleName);
+    std::string readSvgFile(const QString& fileName) const;
+    void executeOp(SimpleReportGenerator& report, const LayoutOp& op, const std::vector<TextStyle*>& styles, const QVariantMap& data) const;
+
+    QString baseDir;
+    std::unique_ptr<SimpleReportGenerator> prototype;
+    std::shared_ptr<TextMetricsCache> textMetrics;
+    std::vector<TextTemplate> headerFooter;   // left, center, right header; left, center, right footer
+    bool hasDataInHeaderFooter{false};
+    QStringList styleNames;
+    std::vector<LayoutOp> ops;
+  };
+
+}
+
+#endif // REPORTTEMPLATE_H
@@ -0,0 +1,183 @@
+/*
+ *    This is SimpleReportGenerator, a very basic report generator on top of Qt.
+ *    Copyright (C) 2014 - 2015  Volker Knollmann
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <iterator>
+
+#include "ReportTextIndex.h"
+
+namespace SimpleReportLib {
+
+  void ReportTextIndex::addRun(int page, const QRectF& box, const QString& txt)
+  {
+    QStringList words = tokenize(txt);
+    if (words.isEmpty()) return;
+
+    const int idx = static_cast<int>(runs.size());
+    runs.push_back(TextRun{page, box, txt});
+
+    // runs are added in ascending order, so the posting lists
+    // remain sorted if we only avoid duplicates within a run
+    for (const QString& word : words)
+    {
+      std::vector<int>& lst = postings[word];
+      if (lst.empty() || (lst.back() != idx)) lst.push_back(idx);
+    }
+  }
+
+  //----------------------------------------------------------------------------
+
+  void ReportTextIndex::clear()
+  {
+    runs.clear();
+    postings.clear();
+  }
+
+  //----------------------------------------------------------------------------
+
+  void ReportTextIndex::save(QDataStream& out) const
+  {
+    out << static_cast<quint32>(runs.size());
+    for (const TextRun& r : runs)
+    {
+      out << static_cast<qint32>(r.page) << r.box << r.text;
+    }
+  }
+
+  //----------------------------------------------------------------------------
+
+  bool ReportTextIndex::load(QDataStream& in)
+  {
+    clear();
+
+    quint32 n;
+    in >> n;
+    for (quint32 i = 0; (i < n) && (in.status() == QDataStream::Ok); ++i)
+    {
+      qint32 page;
+      QRectF box;
+      QString txt;
+      in >> page >> box >> txt;
+      if (in.status() == QDataStream::Ok) addRun(page, box, txt);
+    }
+
+    if (in.status() != QDataStream::Ok)
+    {
+      clear();
+      return false;
+    }
+
+    return true;
+  }
+
+  //----------------------------------------------------------------------------
+
+  std::vector<ReportSearchHit> ReportTextIndex::find(const QString& query) const
+  {
+    QStringList words = tokenize(query);
+    if (words.isEmpty()) return std::vector<ReportSearchHit>{};
+
+    // intersect the posting lists of all words
+    std::vector<int> candidates;
+    for (int i = 0; i < words.size(); ++i)
+    {
+      std::vector<int> lst;
+      if (i == (words.size() - 1))
+      {
+        lst = getPrefixPostings(words.at(i));
+      } else {
+        auto it = postings.constFind(words.at(i));
+        if (it != postings.constEnd()) lst = it.value();
+      }
+
+      if (i == 0)
+      {
+        candidates = std::move(lst);
+      } else {
+        std::vector<int> tmp;
+        std::set_intersection(candidates.begin(), candidates.end(), lst.begin(), lst.end(), std::back_inserter(tmp));
+        candidates = std::move(tmp);
+      }
+
+      if (candidates.empty()) return std::vector<ReportSearchHit>{};
+    }
+
+    // only the candidates' strings have to be checked for
+    // the query's word order and punctuation
+    const QString q = query.simplified();
+    std::vector<ReportSearchHit> result;
+    for (int idx : candidates)
+    {
+      const TextRun& r = runs[idx];
+      if ((words.size() == 1) || r.text.simplified().contains(q, Qt::CaseInsensitive))
+      {
+        result.push_back(ReportSearchHit{r.page, r.box, r.text});
+      }
+    }
+
+    return result;
+  }
+
+  //----------------------------------------------------------------------------
+
+  QStringList ReportTextIndex::tokenize(const QString& txt)
+  {
+    QStringList result;
+
+    QString word;
+    for (const QChar& c : txt)
+    {
+      if (c.isLetterOrNumber())
+      {
+        word.append(c.toLower());
+        continue;
+      }
+
+      if (!(word.isEmpty()))
+      {
+        result.append(word);
+        word.clear();
+      }
+    }
+    if (!(word.isEmpty())) result.append(word);
+
+    return result;
+  }
+
+  //----------------------------------------------------------------------------
+
+  std::vector<int> ReportTextIndex::getPrefixPostings(const QString& prefix) const
+  {
+    std::vector<int> result;
+
+    // all words with the given prefix form a contiguous range in the sorted map
+    for (auto it = postings.lowerBound(prefix); it != postings.constEnd(); ++it)
+    {
+      if (!(it.key().startsWith(prefix))) break;
+      result.insert(result.end(), it.value().begin(), it.value().end());
+    }
+
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+
+    return result;
+  }
+
+  //----------------------------------------------------------------------------
+
+}
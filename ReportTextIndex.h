@@ -0,0 +1,96 @@
+/*
+ *    This is SimpleReportGenerator, a very basic report generator on top of Qt.
+ *    Copyright (C) 2014 - 2015  Volker Knollmann
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef REPORTTEXTINDEX_H
+#define REPORTTEXTINDEX_H
+
+#include <vector>
+
+#include <QDataStream>
+#include <QMap>
+#include <QRectF>
+#include <QString>
+#include <QStringList>
+
+namespace SimpleReportLib {
+
+  /** \brief A hit of a text search: the page and the bounding box of the text run that contains the match
+   */
+  struct ReportSearchHit
+  {
+    int page;
+    QRectF box;   // in internal units
+    QString text;   // the complete text run
+  };
+
+  /** \brief An inverted index of all text runs in a report
+   *
+   * Each text run (page, bounding box, string) is stored once; in addition,
+   * each lower case word of the run points to the run via a sorted posting list.
+   * Searches only touch the posting lists of the query's words and thus don't
+   * depend on the number of items in the report's scenes.
+   */
+  class ReportTextIndex
+  {
+  public:
+    /** \brief Adds a text run; runs have to be added in the order of their creation */
+    void addRun(int page, const QRectF& box, const QString& txt);
+
+    /** \brief Removes all runs */
+    void clear();
+
+    inline int getRunCount() const { return static_cast<int>(runs.size()); }
+
+    /** \brief Writes all runs to a stream; the word index is rebuilt when loading */
+    void save(QDataStream& out) const;
+
+    /** \brief Replaces the current content with runs from a stream
+     *
+     * \returns false if the stream data is invalid; the index is empty in this case
+     */
+    bool load(QDataStream& in);
+
+    /** \brief Searches for text runs that contain the query (case insensitive)
+     *
+     * All words of the query have to be complete words in the run, except for
+     * the last one which may be the beginning of a word ("find as you type").
+     *
+     * \returns all hits in the order of their creation, i.e. sorted by page for regular reports
+     */
+    std::vector<ReportSearchHit> find(const QString& query) const;
+
+    /** \returns the lower case words of a string */
+    static QStringList tokenize(const QString& txt);
+
+  protected:
+    struct TextRun
+    {
+      int page;
+      QRectF box;
+      QString text;
+    };
+
+    std::vector<int> getPrefixPostings(const QString& prefix) const;
+
+    std::vector<TextRun> runs;
+    QMap<QString, std::vector<int>> postings;   // sorted by word for prefix lookups
+  };
+
+}
+
+#endif // REPORTTEXTINDEX_H
@@ -0,0 +1,77 @@
+/*
+ *    This is SimpleReportGenerator, a very basic report generator on top of Qt.
+ *    Copyright (C) 2014 - 2015  Volker Knollmann
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdexcept>
+
+#include "ScatterChart.h"
+#include "ScatterChartItem.h"
+
+namespace SimpleReportLib {
+
+  constexpr double ScatterChart::DEFAULT_MARKER_SIZE__MM;
+  constexpr size_t ScatterChart::DEFAULT_DENSITY_THRESHOLD;
+
+  //----------------------------------------------------------------------------
+
+  ScatterChart::ScatterChart(SimpleReportGenerator* _rep, double _x0, double _y0, double _w, double _h)
+    :LineChart(_rep, _x0, _y0, _w, _h), markerSize(DEFAULT_MARKER_SIZE__MM), densityThreshold(DEFAULT_DENSITY_THRESHOLD)
+  {
+  }
+
+  //----------------------------------------------------------------------------
+
+  void ScatterChart::setMarkerSize(double markerSize_mm)
+  {
+    if (markerSize_mm <= 0)
+    {
+      throw invalid_argument("Invalid marker size for ScatterChart!");
+    }
+
+    markerSize = markerSize_mm;
+  }
+
+  //----------------------------------------------------------------------------
+
+  void ScatterChart::setDensityThreshold(size_t nPoints)
+  {
+    densityThreshold = nPoints;
+  }
+
+  //----------------------------------------------------------------------------
+
+  void ScatterChart::renderData(double xmin, double xmax, double ymin, double ymax)
+  {
+    // a round pen with the marker's diameter; a single
+    // point painted with this pen is a filled circle
+    QPen markerPen = rep->lineType2Pen(LINE_TYPE::MED);
+    markerPen.setWidthF(markerSize * ACCURACY_FAC);
+    markerPen.setCapStyle(Qt::RoundCap);
+
+    QRectF plotRect = getPlotRect__internalUnits();
+    for (const auto& trace : traces)
+    {
+      if (!(isTraceInWindow(*trace, xmin, xmax, ymin, ymax))) continue;
+
+      auto item = make_unique<ScatterChartItem>(trace, xmin, xmax, ymin, ymax, plotRect, markerPen, densityThreshold);
+      rep->addGraphicsItem(std::move(item));
+    }
+  }
+
+  //----------------------------------------------------------------------------
+
+}
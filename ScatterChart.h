@@ -0,0 +1,55 @@
+/*
+ *    This is SimpleReportGenerator, a very basic report generator on top of Qt.
+ *    Copyright (C) 2014 - 2015  Volker Knollmann
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SCATTERCHART_H
+#define SCATTERCHART_H
+
+#include "LineChart.h"
+
+namespace SimpleReportLib {
+
+  /** \brief A chart that shows the points of its traces as unconnected markers
+   *
+   * Coordinate transformation, axes and labels are inherited from the LineChart.
+   * Each trace is rendered by a single ScatterChartItem; traces with more points
+   * than a given threshold are turned into a density image instead of individual markers.
+   */
+  class ScatterChart : public LineChart
+  {
+  public:
+    static constexpr double DEFAULT_MARKER_SIZE__MM = 0.8;
+    static constexpr size_t DEFAULT_DENSITY_THRESHOLD = 100000;
+
+    ScatterChart(SimpleReportGenerator* _rep, double _x0, double _y0, double _w, double _h);
+
+    /** \brief Sets the diameter of the markers; also the cell size of the density image */
+    void setMarkerSize(double markerSize_mm);
+
+    /** \brief Sets the number of points above which a trace is shown as a density image */
+    void setDensityThreshold(size_t nPoints);
+
+  protected:
+    virtual void renderData(double xmin, double xmax, double ymin, double ymax) override;
+
+    double markerSize;
+    size_t densityThreshold;
+  };
+
+}
+
+#endif // SCATTERCHART_H
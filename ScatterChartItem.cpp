@@ -0,0 +1,184 @@
+/*
+ *    This is SimpleReportGenerator, a very basic report generator on top of Qt.
+ *    Copyright (C) 2014 - 2015  Volker Knollmann
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include <QPainter>
+#include <QStyleOptionGraphicsItem>
+
+#include "ScatterChartItem.h"
+
+namespace SimpleReportLib {
+
+  constexpr size_t ScatterChartItem::POINT_BATCH_SIZE;
+  constexpr int ScatterChartItem::MAX_DENSITY_IMAGE_SIZE;
+
+  //----------------------------------------------------------------------------
+
+  ScatterChartItem::ScatterChartItem(const shared_ptr<const ChartTrace>& _trace, double _xmin, double _xmax, double _ymin, double _ymax, const QRectF& _plotRect, const QPen& _markerPen, size_t densityThreshold)
+    :trace(_trace), xmin(_xmin), xmax(_xmax), ymin(_ymin), ymax(_ymax), plotRect(_plotRect), markerPen(_markerPen)
+  {
+    if ((trace == nullptr) || (xmax <= xmin) || (ymax <= ymin) || plotRect.isEmpty() || (markerPen.widthF() <= 0))
+    {
+      throw invalid_argument("Invalid parameters for ScatterChartItem ctor!");
+    }
+
+    // the mapping from "values" to internal units
+    facX = plotRect.width() / (xmax - xmin);
+    facY = plotRect.height() / (ymax - ymin);
+
+    if (trace->size() > densityThreshold) buildDensityImage();
+
+    // we need the exposed rect in paint()
+    setFlag(QGraphicsItem::ItemUsesExtendedStyleOption);
+  }
+
+  //----------------------------------------------------------------------------
+
+  QRectF ScatterChartItem::boundingRect() const
+  {
+    // markers on the border extend by their radius
+    double r = markerPen.widthF() / 2.0;
+    return plotRect.adjusted(-r, -r, r, r);
+  }
+
+  //----------------------------------------------------------------------------
+
+  void ScatterChartItem::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget)
+  {
+    Q_UNUSED(widget);
+
+    if (isDensityImage())
+    {
+      // nearest-neighbor scaling keeps the cells sharp
+      painter->save();
+      painter->setRenderHint(QPainter::SmoothPixmapTransform, false);
+      painter->drawImage(plotRect, densityImage);
+      painter->restore();
+      return;
+    }
+
+    // convert the exposed area back into value space so that we
+    // only process the visible points
+    double clipXMin = xmin;
+    double clipXMax = xmax;
+    double clipYMin = ymin;
+    double clipYMax = ymax;
+    if (option != nullptr)
+    {
+      double r = markerPen.widthF() / 2.0;
+      QRectF exposed = option->exposedRect.adjusted(-r, -r, r, r);
+      clipXMin = max(xmin, xmin + (exposed.left() - plotRect.left()) / facX);
+      clipXMax = min(xmax, xmin + (exposed.right() - plotRect.left()) / facX);
+      clipYMin = max(ymin, ymin + (plotRect.bottom() - exposed.bottom()) / facY);
+      clipYMax = min(ymax, ymin + (plotRect.bottom() - exposed.top()) / facY);
+      if ((clipXMax < clipXMin) || (clipYMax < clipYMin)) return;
+    }
+
+    painter->save();
+    painter->setPen(markerPen);
+
+    // convert and paint the points in fixed-size batches
+    vector<QPointF> batch;
+    batch.reserve(POINT_BATCH_SIZE);
+    const double* xData = trace->xData();
+    const double* yData = trace->yData();
+    for (size_t i = 0; i < trace->size(); ++i)
+    {
+      const double x = xData[i];
+      const double y = yData[i];
+      if (!(std::isfinite(x)) || !(std::isfinite(y))) continue;   // gaps in the trace
+      if ((x < clipXMin) || (x > clipXMax) || (y < clipYMin) || (y > clipYMax)) continue;
+
+      batch.push_back(QPointF{plotRect.left() + (x - xmin) * facX, plotRect.bottom() - (y - ymin) * facY});
+      if (batch.size() == POINT_BATCH_SIZE)
+      {
+        painter->drawPoints(batch.data(), static_cast<int>(batch.size()));
+        batch.clear();
+      }
+    }
+    if (!(batch.empty())) painter->drawPoints(batch.data(), static_cast<int>(batch.size()));
+
+    painter->restore();
+  }
+
+  //----------------------------------------------------------------------------
+
+  void ScatterChartItem::buildDensityImage()
+  {
+    // one cell per marker diameter
+    const double cellSize = markerPen.widthF();
+    const int cols = min(MAX_DENSITY_IMAGE_SIZE, max(1, static_cast<int>(ceil(plotRect.width() / cellSize))));
+    const int rows = min(MAX_DENSITY_IMAGE_SIZE, max(1, static_cast<int>(ceil(plotRect.height() / cellSize))));
+    const double cellFacX = cols / (xmax - xmin);
+    const double cellFacY = rows / (ymax - ymin);
+
+    // count the points per cell
+    vector<uint32_t> counts(static_cast<size_t>(cols) * rows, 0);
+    const double* xData = trace->xData();
+    const double* yData = trace->yData();
+    for (size_t i = 0; i < trace->size(); ++i)
+    {
+      const double x = xData[i];
+      const double y = yData[i];
+      if (!(std::isfinite(x)) || !(std::isfinite(y))) continue;   // gaps in the trace
+      if ((x < xmin) || (x > xmax) || (y < ymin) || (y > ymax)) continue;
+
+      const int c = min(cols - 1, static_cast<int>((x - xmin) * cellFacX));
+      const int r = min(rows - 1, static_cast<int>((ymax - y) * cellFacY));
+      ++counts[static_cast<size_t>(r) * cols + c];
+    }
+    const uint32_t maxCount = *(max_element(counts.begin(), counts.end()));
+    if (maxCount == 0)
+    {
+      // nothing visible at all; paint an empty image
+      densityImage = QImage{cols, rows, QImage::Format_ARGB32_Premultiplied};
+      densityImage.fill(Qt::transparent);
+      return;
+    }
+
+    // map the counts logarithmically onto the opacity of the marker color;
+    // occupied cells get a minimum opacity so that single points remain visible
+    const QColor col = markerPen.color();
+    const double logMax = log(1.0 + maxCount);
+    densityImage = QImage{cols, rows, QImage::Format_ARGB32_Premultiplied};
+    for (int r = 0; r < rows; ++r)
+    {
+      QRgb* line = reinterpret_cast<QRgb*>(densityImage.scanLine(r));
+      const uint32_t* cnt = counts.data() + static_cast<size_t>(r) * cols;
+      for (int c = 0; c < cols; ++c)
+      {
+        if (cnt[c] == 0)
+        {
+          line[c] = 0;
+          continue;
+        }
+
+        const int alpha = 64 + static_cast<int>(191.0 * log(1.0 + cnt[c]) / logMax);
+        line[c] = qRgba(col.red() * alpha / 255, col.green() * alpha / 255, col.blue() * alpha / 255, alpha);
+      }
+    }
+  }
+
+  //----------------------------------------------------------------------------
+
+}
@@ -0,0 +1,83 @@
+/*
+ *    This is SimpleReportGenerator, a very basic report generator on top of Qt.
+ *    Copyright (C) 2014 - 2015  Volker Knollmann
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SCATTERCHARTITEM_H
+#define SCATTERCHARTITEM_H
+
+#include <memory>
+
+#include <QGraphicsItem>
+#include <QImage>
+#include <QPen>
+
+#include "LineChart.h"
+
+namespace SimpleReportLib {
+
+  /** \brief A graphics item that paints all points of a trace as markers
+   *
+   * Markers are painted in batches with QPainter::drawPoints(). If the trace has more
+   * points than a given threshold, the points are binned into a density image
+   * once and only the image is painted.
+   *
+   * The item's coordinates are the page's internal coordinates (mm * ACCURACY_FAC).
+   */
+  class ScatterChartItem : public QGraphicsItem
+  {
+  public:
+    /** \brief the number of points that are passed to QPainter::drawPoints() at once */
+    static constexpr size_t POINT_BATCH_SIZE = 4096;
+
+    /** \brief the max. width or height of the density image in pixels */
+    static constexpr int MAX_DENSITY_IMAGE_SIZE = 2048;
+
+    ScatterChartItem(
+        const shared_ptr<const ChartTrace>& _trace,   ///< the data to be painted
+        double _xmin,   ///< the left boundary of the plot window in value space
+        double _xmax,   ///< the right boundary of the plot window in value space
+        double _ymin,   ///< the lower boundary of the plot window in value space
+        double _ymax,   ///< the upper boundary of the plot window in value space
+        const QRectF& _plotRect,   ///< the plot area in internal units
+        const QPen& _markerPen,   ///< the pen for the markers; its width is the marker diameter
+        size_t densityThreshold   ///< more points than this: paint a density image
+        );
+
+    virtual QRectF boundingRect() const override;
+    virtual void paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget = nullptr) override;
+
+    /** \returns true if the points are shown as a density image */
+    inline bool isDensityImage() const { return !(densityImage.isNull()); }
+
+  protected:
+    void buildDensityImage();
+
+    shared_ptr<const ChartTrace> trace;
+    double xmin;
+    double xmax;
+    double ymin;
+    double ymax;
+    QRectF plotRect;
+    QPen markerPen;
+    double facX;
+    double facY;
+    QImage densityImage;
+  };
+
+}
+
+#endif // SCATTERCHARTITEM_H
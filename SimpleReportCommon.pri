@@ -0,0 +1,23 @@
+# settings that are shared by the core library and the viewer library
+
+CONFIG += c++14 debug_and_release dll build_all
+
+VERSION = 0.3.2
+
+DEFINES += SIMPLEREPORTGENERATOR_LIBRARY
+
+unix {
+    target.path = /usr/local/lib
+    header_files.path = /usr/local/include/SimpleReportGeneratorLib
+    header_files.files = $$HEADERS
+    INSTALLS += header_files
+}
+
+!unix {
+    target.path = D:/msys64/usr/local/lib
+    header_files.path = D:/msys64/usr/local/include/SimpleReportGeneratorLib
+    header_files.files = $$HEADERS
+    INSTALLS += header_files
+}
+
+INSTALLS += target
@@ -0,0 +1,69 @@
+#-------------------------------------------------
+#
+# The layout engine and the exporters, without
+# the viewer and printing code. This is NOT a
+# QtGui-only library: the pages are QGraphicsScenes,
+# which need QtWidgets and a QApplication
+#
+#-------------------------------------------------
+
+# QtWidgets is only needed for QGraphicsScene, which
+# works without a display (e.g., "-platform offscreen")
+QT       += widgets svg
+
+TARGET = SimpleReportGenerator
+
+CONFIG(debug, debug|release) {
+  TARGET = SimpleReportGeneratord
+}
+
+TEMPLATE = lib
+
+SOURCES += SimpleReportGenerator.cpp \
+    TabSet.cpp \
+    TableWriter.cpp \
+    TextStyle.cpp \
+    TextStyleLib.cpp \
+    LineChart.cpp \
+    LineChartItem.cpp \
+    ScatterChart.cpp \
+    ScatterChartItem.cpp \
+    HistogramChart.cpp \
+    HeatmapChart.cpp \
+    ReportTextIndex.cpp \
+    ReportArchive.cpp \
+    PageImageExporter.cpp \
+    PdfExporter.cpp \
+    PictureItem.cpp \
+    ImageItem.cpp \
+    SvgItem.cpp \
+    TextMetricsCache.cpp \
+    ReportBatchRunner.cpp \
+    JsonReportBuilder.cpp \
+    ReportTemplate.cpp
+
+HEADERS += SimpleReportGenerator.h\
+        #simplereportgenerator_global.h \
+    TabSet.h \
+    TableWriter.h \
+    TextStyle.h \
+    TextStyleLib.h \
+    LineChart.h \
+    LineChartItem.h \
+    ScatterChart.h \
+    ScatterChartItem.h \
+    HistogramChart.h \
+    HeatmapChart.h \
+    ReportTextIndex.h \
+    ReportArchive.h \
+    PageImageExporter.h \
+    PdfExporter.h \
+    PictureItem.h \
+    ImageItem.h \
+    SvgItem.h \
+    TextMetricsCache.h \
+    ReportBatchRunner.h \
+    JsonReportBuilder.h \
+    ReportTemplate.h
+
+include(SimpleReportCommon.pri)
@@ -20,13 +20,15 @@
 
 #include <stdexcept>
 #include <assert.h>
+#include <climits>
 #include <iostream>
 #include <math.h>
 
 #include <QGraphicsLineItem>
 #include <QHash>
 #include <QDateTime>
-#include <QtSvg/QGraphicsSvgItem>
+#include <QCryptographicHash>
+#include <QScopedValueRollback>
 
 using namespace std;
 
@@ -156,6 +158,9 @@ namespace SimpleReportLib {
     headerStyle->setItalicsState(true);
 
     curY = -1.0;
+
+    textIndex = make_unique<ReportTextIndex>();
+    textMetrics = make_shared<TextMetricsCache>();
   }
 
   //---------------------------------------------------------------------------
@@ -165,6 +170,37 @@ namespace SimpleReportLib {
 
   //---------------------------------------------------------------------------
 
+  unique_ptr<SimpleReportGenerator> SimpleReportGenerator::cloneConfiguration() const
+  {
+    // a master page that is still being edited hasn't been recorded yet
+    // and thus can't be shared; the clone starts with the last recorded one
+    auto result = make_unique<SimpleReportGenerator>(w / ACCURACY_FAC, h / ACCURACY_FAC, margin / ACCURACY_FAC);
+
+    result->globalHeaderFooter = globalHeaderFooter;
+    result->thinPen = thinPen;
+    result->mediumPen = mediumPen;
+    result->thickPen = thickPen;
+    result->tabSet = tabSet;
+    result->tabStack = tabStack;
+    result->styleLib = styleLib;
+
+    // the clone is usually rendered on another thread; so it gets
+    // its own copies of the pictures instead of sharing them
+    result->masterPicture = PictureItem::deepCopy(masterPicture);
+    result->masterTextRuns = masterTextRuns;
+    result->masterSvgs = masterSvgs;
+    result->sharedHeaderFooterKey = sharedHeaderFooterKey;
+    result->sharedHeaderFooterPicture = PictureItem::deepCopy(sharedHeaderFooterPicture);
+    result->sharedHeaderFooterTextRuns = sharedHeaderFooterTextRuns;
+
+    // thread-safe, so we can share it
+    result->textMetrics = textMetrics;
+
+    return result;
+  }
+
+  //---------------------------------------------------------------------------
+
   SimpleReportGenerator::~SimpleReportGenerator() {
     //deleteAllPages();
   }
@@ -179,6 +215,9 @@ namespace SimpleReportLib {
 
   void SimpleReportGenerator::startNextPage()
   {
+    // starting a new page implicitly finishes an open master page
+    if (masterScene != nullptr) endMasterPage();
+
     // start a new scene ( = page) and initialize it accordingly
     auto newScene = make_unique<QGraphicsScene>(0, 0, w, h);
     curPagePtr = newScene.get();
@@ -190,11 +229,27 @@ namespace SimpleReportLib {
     idxCurPage = pages.size() - 1;
 
     // limit the scene size to the paper size
-    // and add a "page frame" for zooming as a background
+    // and add the master page; it contains at least
+    // a "page frame" for zooming as a background
     // color in the viewer
-    QPen pen(Qt::white, 0);
     curPagePtr->setSceneRect(0, 0, w, h);
-    curPagePtr->addRect(0,0,w,h,pen, QBrush(Qt::white));
+    if (masterPicture == nullptr)
+    {
+      auto blankMaster = createMasterScene();
+      masterPicture = PictureItem::recordScene(blankMaster.get(), QRectF{0, 0, w, h});
+    }
+    PictureItem* masterItem = addSharedPicture(curPagePtr, masterPicture, masterTextRuns, idxCurPage);
+    masterItem->setZValue(-1);
+
+    // the master page's SVGs are real items on each page, so that
+    // exporters can still identify them as repeated content
+    for (const MasterSvg& ms : masterSvgs)
+    {
+      auto svgItem = new SvgItem{ms.svgData, ms.contentHash, ms.defaultSize};
+      svgItem->setTransform(ms.transform);
+      svgItem->setZValue(-1);
+      curPagePtr->addItem(svgItem);   // the scene takes ownership
+    }
 
     // reserve space for header and footer
     double headerFooterHeight = HEADER_FOOTER_SKIP__MM * ACCURACY_FAC + getTextHeightForStyle(DEFAULT_HEADER_STYLE_NAME);
@@ -204,9 +259,157 @@ namespace SimpleReportLib {
 
   //---------------------------------------------------------------------------
 
+  void SimpleReportGenerator::beginMasterPage()
+  {
+    if (masterScene != nullptr) return;
+
+    masterScene = createMasterScene();
+    curPageBeforeMaster = curPagePtr;
+    curPagePtr = masterScene.get();
+  }
+
+  //---------------------------------------------------------------------------
+
+  void SimpleReportGenerator::endMasterPage()
+  {
+    if (masterScene == nullptr) return;
+
+    // text on the master page is indexed for each page that uses it,
+    // so we only store the runs here
+    masterTextRuns.clear();
+    for (QGraphicsItem* item : masterScene->items(Qt::AscendingOrder))
+    {
+      auto txtItem = qgraphicsitem_cast<QGraphicsSimpleTextItem*>(item);
+      if (txtItem == nullptr) continue;
+      masterTextRuns.push_back(make_pair(QRectF{txtItem->pos(), txtItem->boundingRect().size()}, txtItem->text()));
+    }
+
+    // SVGs are not recorded into the picture but added to
+    // each page individually (see startNextPage())
+    masterSvgs.clear();
+    for (QGraphicsItem* item : masterScene->items(Qt::AscendingOrder))
+    {
+      auto svgItem = qgraphicsitem_cast<SvgItem*>(item);
+      if (svgItem == nullptr) continue;
+      masterSvgs.push_back(MasterSvg{svgItem->getSvgData(), svgItem->getContentHash(), svgItem->getDefaultSize(), svgItem->sceneTransform()});
+      masterScene->removeItem(svgItem);
+      delete svgItem;
+    }
+
+    masterPicture = PictureItem::recordScene(masterScene.get(), QRectF{0, 0, w, h});
+
+    curPagePtr = curPageBeforeMaster;
+    curPageBeforeMaster = nullptr;
+    masterScene.reset();
+  }
+
+  //---------------------------------------------------------------------------
+
   int SimpleReportGenerator::getPageCount()
   {
-    return pages.size();
+    const int nPages = pages.size();
+    if (isPageCountFinal() || (idxNextSection == 0)) return nPages;
+
+    // extrapolate the total number of pages
+    // from the sections that have been laid out so far
+    double pagesPerSection = static_cast<double>(nPages) / idxNextSection;
+    int estimate = static_cast<int>(ceil(pagesPerSection * sections.size()));
+
+    return max(nPages, estimate);
+  }
+
+  //---------------------------------------------------------------------------
+
+  void SimpleReportGenerator::addSection(const ReportSection& section)
+  {
+    if (!section) return;
+
+    sections.push_back(section);
+  }
+
+  //---------------------------------------------------------------------------
+
+  bool SimpleReportGenerator::layoutUntilPage(int idxPage)
+  {
+    if (idxPage < 0) return false;
+
+    // a section that calls a function which requires
+    // all pages (e.g., applyHeaderAndFooterOnAllPages())
+    // must not execute the following sections
+    if (isLayoutRunning) return (idxPage < pages.size());
+    QScopedValueRollback<bool> layoutFlag{isLayoutRunning, true};
+
+    while ((idxPage >= pages.size()) && !(isPageCountFinal()))
+    {
+      // continue exactly where the previous section ended, even
+      // if the cursor has been moved in the meantime (e.g., by
+      // setActivePage() or by inserting headers and footers)
+      restoreCheckpoint();
+
+      // advance first so that a failing section isn't executed twice
+      ReportSection& sec = sections[idxNextSection];
+      ++idxNextSection;
+      sec(*this);
+
+      saveCheckpoint();
+    }
+
+    // release the sections (and everything they've captured)
+    // once the report is complete
+    if (!(sections.empty()) && isPageCountFinal())
+    {
+      sections.clear();
+      idxNextSection = 0;
+    }
+
+    return (idxPage < pages.size());
+  }
+
+  //---------------------------------------------------------------------------
+
+  void SimpleReportGenerator::appendPicturePage(shared_ptr<const QPicture> pic)
+  {
+    auto newScene = make_unique<QGraphicsScene>(0, 0, w, h);
+    newScene->setSceneRect(0, 0, w, h);
+    newScene->addItem(new PictureItem(pic, QRectF{0, 0, w, h}));
+
+    pages.push_back(std::move(newScene));
+    headerFooter.push_back(unique_ptr<HeaderFooterStrings>{});
+  }
+
+  //---------------------------------------------------------------------------
+
+  void SimpleReportGenerator::layoutAllSections()
+  {
+    layoutUntilPage(INT_MAX);
+  }
+
+  //---------------------------------------------------------------------------
+
+  void SimpleReportGenerator::saveCheckpoint()
+  {
+    // text styles are named definitions in the style lib that
+    // are not part of the cursor state; they persist anyway
+    if (checkpoint == nullptr) checkpoint = make_unique<LayoutCheckpoint>();
+    checkpoint->idxCurPage = idxCurPage;
+    checkpoint->curY = curY;
+    checkpoint->maxY = maxY;
+    checkpoint->tabSet = tabSet;
+    checkpoint->tabStack = tabStack;
+  }
+
+  //---------------------------------------------------------------------------
+
+  void SimpleReportGenerator::restoreCheckpoint()
+  {
+    if ((checkpoint == nullptr) || (checkpoint->idxCurPage >= pages.size())) return;
+
+    idxCurPage = checkpoint->idxCurPage;
+    curPagePtr = pages[idxCurPage].get();
+    curY = checkpoint->curY;
+    maxY = checkpoint->maxY;
+    tabSet = checkpoint->tabSet;
+    tabStack = checkpoint->tabStack;
   }
 
   //---------------------------------------------------------------------------
@@ -215,7 +418,10 @@ namespace SimpleReportLib {
   {
     if ((idxPage < 0) || (idxPage >= pages.size())) return false;
 
-    curPagePtr = pages.at(idxPage).get();
+    // the page might be modified now; pin it before decoding it
+    // so that a render thread can't release it meanwhile
+    pinPage(idxPage);
+    curPagePtr = getPage(idxPage);
     idxCurPage = idxPage;
 
     return true;
@@ -225,13 +431,47 @@ namespace SimpleReportLib {
 
   QGraphicsScene* SimpleReportGenerator::getPage(int idxPage)
   {
-    if (idxPage >= pages.size()) return nullptr;
+    if ((idxPage < 0) || (idxPage >= pages.size())) return nullptr;
+
+    // pages of loaded reports are decoded on first access; the viewer's
+    // render thread and the GUI thread might do that at the same time
+    if (archive != nullptr)
+    {
+      std::lock_guard<std::mutex> lock{archiveMutex};
+      if (pages[idxPage] == nullptr) pages[idxPage] = archive->materializePage(idxPage);
+      return pages[idxPage].get();
+    }
 
     return pages.at(idxPage).get();
   }
 
   //---------------------------------------------------------------------------
 
+  bool SimpleReportGenerator::releasePage(int idxPage)
+  {
+    if ((idxPage < 0) || (idxPage >= pages.size())) return false;
+
+    // pages that have been added after loading only exist in memory
+    if ((archive == nullptr) || (idxPage >= archive->getPageCount())) return false;
+
+    std::lock_guard<std::mutex> lock{archiveMutex};
+    if (pinnedPages.contains(idxPage) || (pages[idxPage] == nullptr)) return false;
+    if (pages[idxPage].get() == curPagePtr) return false;
+
+    pages[idxPage].reset();
+    return true;
+  }
+
+  //---------------------------------------------------------------------------
+
+  void SimpleReportGenerator::pinPage(int idxPage)
+  {
+    std::lock_guard<std::mutex> lock{archiveMutex};
+    pinnedPages.insert(idxPage);
+  }
+
+  //---------------------------------------------------------------------------
+
   void SimpleReportGenerator::writeLine(QString txt, const QString& styleName, double skipAfter, double skipBefore)
   {
     auto style = styleLib.getStyle(styleName);
@@ -265,6 +505,7 @@ namespace SimpleReportLib {
       // no tabs defined, simply write out the text
       QGraphicsSimpleTextItem* txtItem = curPagePtr->addSimpleText(txt, fnt);
       auto bb = setTextPosAligned(margin, curY, txtItem);
+      indexTextItem(txtItem);
       txtHeight = bb.height();
     } else {
       QStringList txtChunk = txt.split("\t");
@@ -274,6 +515,7 @@ namespace SimpleReportLib {
       // the text
       QGraphicsSimpleTextItem* txtItem = curPagePtr->addSimpleText(txtChunk.at(0).trimmed(), fnt);
       auto bb = setTextPosAligned(margin, curY, txtItem);
+      indexTextItem(txtItem);
       txtHeight = bb.height();
       txtChunk.removeFirst();
 
@@ -297,6 +539,7 @@ namespace SimpleReportLib {
         txtItem = curPagePtr->addSimpleText(txtChunk.at(tabIndex).trimmed(), fnt);
         double chunkHeight;
         auto bb = setTextPosAligned(td.pos * ACCURACY_FAC + margin, curY, txtItem, align);
+        indexTextItem(txtItem);
         chunkHeight = bb.height();
         txtHeight = qMax(txtHeight, chunkHeight);
       }
@@ -406,7 +649,10 @@ namespace SimpleReportLib {
   {
     if (pages.size() < 1) return;
 
-    QGraphicsScene* sc = (idxPage < 0) ? curPagePtr : pages[idxPage].get();
+    if (idxPage < 0) idxPage = idxCurPage;
+    pinPage(idxPage);
+    QGraphicsScene* sc = getPage(idxPage);
+    if (sc == nullptr) return;
 
     auto headerStyle = styleLib.getStyle(DEFAULT_HEADER_STYLE_NAME);
     if (headerStyle == nullptr) headerStyle = styleLib.getStyle();
@@ -421,55 +667,104 @@ namespace SimpleReportLib {
     } else {
       hfStrings = globalHeaderFooter;
     }
+    const HeaderFooterStrings rawStrings = hfStrings;
 
     // insert actual date, time, page numbers, etc
-    hfStrings.substTokens((idxPage < 0) ? idxCurPage : idxPage, pages.size());
-
-    // write out the text for the header
-    if (!(hfStrings.hl.isEmpty()))
-    {
-      QGraphicsSimpleTextItem* txtItem = sc->addSimpleText(hfStrings.hl, headerFont);
-      setTextPosAligned(margin, margin, txtItem);
-    }
-    if (!(hfStrings.hc.isEmpty()))
+    hfStrings.substTokens(idxPage, pages.size());
+
+    // fields with the current page number have to be written
+    // for each page individually; all other fields are identical
+    // on all pages (as long as the strings don't change) and are thus
+    // only recorded once and shared by all pages
+    const QString rawFields[] = {rawStrings.hl, rawStrings.hc, rawStrings.hr, rawStrings.fl, rawStrings.fc, rawStrings.fr};
+    const QString fields[] = {hfStrings.hl, hfStrings.hc, hfStrings.hr, hfStrings.fl, hfStrings.fc, hfStrings.fr};
+    QString sharedKey = headerFont.toString();
+    vector<int> sharedSlots;
+    for (int slot = 0; slot < 6; ++slot)
     {
-      QGraphicsSimpleTextItem* txtItem = sc->addSimpleText(hfStrings.hc, headerFont);
-      setTextPosAligned(w/2.0, margin, txtItem, CENTER);
-    }
-    if (!(hfStrings.hr.isEmpty()))
-    {
-      QGraphicsSimpleTextItem* txtItem = sc->addSimpleText(hfStrings.hr, headerFont);
-      setTextPosAligned(w - margin, margin, txtItem, RIGHT);
-    }
+      if (fields[slot].isEmpty()) continue;
 
-    // write out the text for the footer
-    if (!(hfStrings.fl.isEmpty()))
-    {
-      QGraphicsSimpleTextItem* txtItem = sc->addSimpleText(hfStrings.fl, headerFont);
-      auto bb = setTextPosAligned(margin, h - margin, txtItem);
-      double txtHeight = bb.height();
-      txtItem->moveBy(0, -txtHeight);
+      if (rawFields[slot].contains(HeaderFooterStrings::TOKEN_CURPGNUM))
+      {
+        QGraphicsSimpleTextItem* txtItem = sc->addSimpleText(fields[slot], headerFont);
+        placeHeaderFooterText(txtItem, slot);
+        indexTextItem(txtItem, idxPage);
+      } else {
+        sharedSlots.push_back(slot);
+        sharedKey += QString("\n%1:%2").arg(slot).arg(fields[slot]);
+      }
     }
-    if (!(hfStrings.fc.isEmpty()))
+    if (sharedSlots.empty()) return;
+
+    if (sharedKey != sharedHeaderFooterKey)
     {
-      QGraphicsSimpleTextItem* txtItem = sc->addSimpleText(hfStrings.fc, headerFont);
-      auto bb = setTextPosAligned(w/2.0, h - margin, txtItem, CENTER);
-      double txtHeight = bb.height();
-      txtItem->moveBy(0, -txtHeight);
+      QGraphicsScene tmpScene(0, 0, w, h);
+      sharedHeaderFooterTextRuns.clear();
+      for (int slot : sharedSlots)
+      {
+        QGraphicsSimpleTextItem* txtItem = tmpScene.addSimpleText(fields[slot], headerFont);
+        placeHeaderFooterText(txtItem, slot);
+        sharedHeaderFooterTextRuns.push_back(make_pair(QRectF{txtItem->pos(), txtItem->boundingRect().size()}, txtItem->text()));
+      }
+      sharedHeaderFooterPicture = PictureItem::recordScene(&tmpScene, QRectF{0, 0, w, h});
+      sharedHeaderFooterKey = sharedKey;
     }
-    if (!(hfStrings.fr.isEmpty()))
+
+    addSharedPicture(sc, sharedHeaderFooterPicture, sharedHeaderFooterTextRuns, idxPage);
+  }
+
+//---------------------------------------------------------------------------
+
+  void SimpleReportGenerator::placeHeaderFooterText(QGraphicsSimpleTextItem* txtItem, int slot) const
+  {
+    // slots 0...2 are left, center and right header;
+    // slots 3...5 are left, center and right footer
+    static const HOR_TXT_ALIGNMENT align[] = {LEFT, CENTER, RIGHT};
+    const double x[] = {margin, w/2.0, w - margin};
+
+    if (slot < 3)
     {
-      QGraphicsSimpleTextItem* txtItem = sc->addSimpleText(hfStrings.fr, headerFont);
-      auto bb = setTextPosAligned(w - margin, h - margin, txtItem, RIGHT);
+      setTextPosAligned(x[slot], margin, txtItem, align[slot]);
+    } else {
+      auto bb = setTextPosAligned(x[slot - 3], h - margin, txtItem, align[slot - 3]);
       double txtHeight = bb.height();
       txtItem->moveBy(0, -txtHeight);
     }
   }
 
+//---------------------------------------------------------------------------
+
+  PictureItem* SimpleReportGenerator::addSharedPicture(QGraphicsScene* sc, shared_ptr<const QPicture> pic,
+                                                       const vector<pair<QRectF, QString>>& textRuns, int idxPage) const
+  {
+    auto item = new PictureItem(pic, QRectF{0, 0, w, h});
+    sc->addItem(item);
+
+    // the text in the picture is searchable on each page
+    for (const auto& run : textRuns) textIndex->addRun(idxPage, run.first, run.second);
+
+    return item;
+  }
+
+//---------------------------------------------------------------------------
+
+  unique_ptr<QGraphicsScene> SimpleReportGenerator::createMasterScene() const
+  {
+    auto sc = make_unique<QGraphicsScene>(0, 0, w, h);
+
+    QPen pen(Qt::white, 0);
+    sc->addRect(0, 0, w, h, pen, QBrush(Qt::white));
+
+    return sc;
+  }
+
 //---------------------------------------------------------------------------
 
   void SimpleReportGenerator::applyHeaderAndFooterOnAllPages()
   {
+    // the total page count is needed for the page number tokens
+    layoutAllSections();
+
     if (pages.empty()) return;
     for (int pg = 0; pg < pages.size(); ++pg) insertHeaderAndFooter(pg);
   }
@@ -586,6 +881,13 @@ namespace SimpleReportLib {
 
   //---------------------------------------------------------------------------
 
+  double SimpleReportGenerator::getMargin()
+  {
+    return margin / ACCURACY_FAC;
+  }
+
+  //---------------------------------------------------------------------------
+
   double SimpleReportGenerator::getUsablePageWidth() const
   {
     return (w - 2 * margin) / ACCURACY_FAC;
@@ -600,6 +902,14 @@ namespace SimpleReportLib {
 
   //---------------------------------------------------------------------------
 
+  double SimpleReportGenerator::getRemainingPageHeight() const
+  {
+    // the space between the cursor and the footer
+    return max(0.0, (maxY - curY) / ACCURACY_FAC);
+  }
+
+  //---------------------------------------------------------------------------
+
   TextStyle* SimpleReportGenerator::getTextStyle(const QString &styleName) const
   {
     return styleLib.getStyle(styleName);
@@ -630,14 +940,7 @@ namespace SimpleReportLib {
     QString txt = sampleText;
     if (txt.isEmpty()) txt = "X²g^j_";
 
-    // add the text to the scene, determine the heigth and
-    // immediately remove it
-    QGraphicsSimpleTextItem* txtItem = curPagePtr->addSimpleText(txt, *fnt);
-    double result = txtItem->boundingRect().height();
-    curPagePtr->removeItem(txtItem);
-    delete txtItem;
-
-    return result;
+    return measureText__internalUnits(txt, *fnt).height();
   }
 
   //---------------------------------------------------------------------------
@@ -680,8 +983,10 @@ namespace SimpleReportLib {
     }
 
     QGraphicsSimpleTextItem* txtItem = curPagePtr->addSimpleText(txt, fnt);
+    QRectF bb = setTextPosAligned(x0, y0, txtItem, align);
+    indexTextItem(txtItem);
 
-    return setTextPosAligned(x0, y0, txtItem, align);
+    return bb;
   }
 
   //---------------------------------------------------------------------------
@@ -691,7 +996,10 @@ namespace SimpleReportLib {
     QGraphicsSimpleTextItem* txtItem = addStyledTextItem(txt, styleName);
     if (txtItem == nullptr) return QRectF();
 
-    return moveTextItem(txtItem, basePoint, basePointAlignment);
+    QRectF bb = moveTextItem(txtItem, basePoint, basePointAlignment);
+    indexTextItem(txtItem);
+
+    return bb;
   }
 
   //---------------------------------------------------------------------------
@@ -701,7 +1009,10 @@ namespace SimpleReportLib {
     QGraphicsSimpleTextItem* txtItem = addStyledTextItem(txt, style);
     if (txtItem == nullptr) return QRectF();
 
-    return moveTextItem(txtItem, basePoint, basePointAlignment);
+    QRectF bb = moveTextItem(txtItem, basePoint, basePointAlignment);
+    indexTextItem(txtItem);
+
+    return bb;
   }
 
   //---------------------------------------------------------------------------
@@ -821,6 +1132,7 @@ namespace SimpleReportLib {
       QPointF srcPos = item->pos();
       QPointF targetPos = srcPos + translationVector;
       item->setPos(targetPos);
+      indexTextItem(item);
     }
 
     // return the resulting overall bounding box
@@ -843,6 +1155,112 @@ namespace SimpleReportLib {
 
   //---------------------------------------------------------------------------
 
+  void SimpleReportGenerator::indexTextItem(const QGraphicsSimpleTextItem* item, int idxPage) const
+  {
+    if (item == nullptr) return;
+
+    // text on the master page is indexed by endMasterPage()
+    if ((masterScene != nullptr) && (item->scene() == masterScene.get())) return;
+
+    // the item has to be at its final position; use the same
+    // bounding box convention as moveTextItem()
+    QRectF box{item->pos(), item->boundingRect().size()};
+    textIndex->addRun((idxPage < 0) ? idxCurPage : idxPage, box, item->text());
+  }
+
+  //---------------------------------------------------------------------------
+
+  std::vector<ReportSearchHit> SimpleReportGenerator::findText(const QString& query) const
+  {
+    ensureTextIndexLoaded();
+
+    return textIndex->find(query);
+  }
+
+  //---------------------------------------------------------------------------
+
+  void SimpleReportGenerator::ensureTextIndexLoaded() const
+  {
+    // the text runs of loaded reports are decoded on first use
+    if (isTextIndexLoaded || (archive == nullptr)) return;
+
+    archive->loadTextIndex(*textIndex);
+    isTextIndexLoaded = true;
+  }
+
+  //---------------------------------------------------------------------------
+
+  bool SimpleReportGenerator::saveToFile(const QString& fileName)
+  {
+    // make sure that the index contains the text of loaded reports
+    ensureTextIndexLoaded();
+
+    return ReportArchive::write(fileName, w, h, margin, getAllPages(), *textIndex);
+  }
+
+  //---------------------------------------------------------------------------
+
+  ImageExportStats SimpleReportGenerator::exportPagesAsImages(const QString& dirName, int dpi, const QString& format, int nThreads)
+  {
+    // decode all pages of loaded reports here, so that
+    // the worker threads don't modify the page list
+    PageImageExporter exporter{getAllPages(), w, h};
+    return exporter.exportAll(dirName, dpi, format, nThreads);
+  }
+
+  //---------------------------------------------------------------------------
+
+  bool SimpleReportGenerator::exportPdf(const QString& fileName, const PdfExportOptions& options)
+  {
+    PdfExporter exporter{getAllPages(), w, h};
+    return exporter.exportPdf(fileName, options);
+  }
+
+  //---------------------------------------------------------------------------
+
+  std::vector<QGraphicsScene*> SimpleReportGenerator::getAllPages()
+  {
+    layoutAllSections();
+
+    std::vector<QGraphicsScene*> allPages;
+    allPages.reserve(pages.size());
+    for (int idx = 0; idx < pages.size(); ++idx) allPages.push_back(getPage(idx));
+
+    return allPages;
+  }
+
+  //---------------------------------------------------------------------------
+
+  unique_ptr<SimpleReportGenerator> SimpleReportGenerator::loadFromFile(const QString& fileName)
+  {
+    auto ar = ReportArchive::open(fileName);
+    if (ar == nullptr) return nullptr;
+
+    double _w = ar->getPageWidth__internalUnits() / ACCURACY_FAC;
+    double _h = ar->getPageHeight__internalUnits() / ACCURACY_FAC;
+    double _margin = ar->getMargin__internalUnits() / ACCURACY_FAC;
+    unique_ptr<SimpleReportGenerator> result;
+    try
+    {
+      result = make_unique<SimpleReportGenerator>(_w, _h, _margin);
+    }
+    catch (std::invalid_argument&)
+    {
+      return nullptr;
+    }
+
+    // empty slots for all pages; they're filled by getPage()
+    int nPages = ar->getPageCount();
+    result->pages.resize(nPages);
+    result->headerFooter.resize(nPages);
+    result->archive = std::move(ar);
+    result->isTextIndexLoaded = false;
+
+    return result;
+  }
+
+  //---------------------------------------------------------------------------
+
   QRectF SimpleReportGenerator::drawText(double x0, double y0, const QString& txt, const QString& styleName, HOR_TXT_ALIGNMENT align) const
   {
     QRectF internalRect = drawText__internalUnits(x0 * ACCURACY_FAC, y0*ACCURACY_FAC, txt, styleName, align);
@@ -934,7 +1352,7 @@ namespace SimpleReportLib {
   {
     if (!curPagePtr) return QRectF{};
     // prep a new SVG item
-    std::unique_ptr<QGraphicsSvgItem> svgItem = std::move(prepSvgItem(svgContent));
+    std::unique_ptr<SvgItem> svgItem = std::move(prepSvgItem(svgContent));
     if (!svgItem) return QRectF{};
 
     // apply the scaling
@@ -950,7 +1368,7 @@ namespace SimpleReportLib {
   {
     if (!curPagePtr) return QRectF{};
     // prep a new SVG item
-    std::unique_ptr<QGraphicsSvgItem> svgItem = std::move(prepSvgItem(svgContent));
+    std::unique_ptr<SvgItem> svgItem = std::move(prepSvgItem(svgContent));
     if (!svgItem) return QRectF{};
 
     if (width_mm <= 0) return addSVG(basePoint, basePointAlignment, std::move(svgItem));
@@ -971,7 +1389,7 @@ namespace SimpleReportLib {
   {
     if (!curPagePtr) return QRectF{};
     // prep a new SVG item
-    std::unique_ptr<QGraphicsSvgItem> svgItem = std::move(prepSvgItem(svgContent));
+    std::unique_ptr<SvgItem> svgItem = std::move(prepSvgItem(svgContent));
     if (!svgItem) return QRectF{};
 
     if (height_mm <= 0) return addSVG(basePoint, basePointAlignment, std::move(svgItem));
@@ -998,12 +1416,7 @@ namespace SimpleReportLib {
     if (style == nullptr) style = styleLib.getStyle();
     auto fnt = style->getFont();
 
-    // add the text to the scene, determine the size and
-    // immediately remove it
-    QGraphicsSimpleTextItem* txtItem = curPagePtr->addSimpleText(txt, *fnt);
-    QSizeF result_internalUnits = txtItem->boundingRect().size();
-    curPagePtr->removeItem(txtItem);
-    delete txtItem;
+    QSizeF result_internalUnits = measureText__internalUnits(txt, *fnt);
 
     // convert internal units to external units (mm) and return the result
     return (result_internalUnits / ACCURACY_FAC);
@@ -1023,9 +1436,11 @@ namespace SimpleReportLib {
 
     // locally memorize the last used font so that
     // we don't have to create it time and again if
-    // we get multiple queries in a row
-    static std::unique_ptr<QFont> fnt;
-    static QString lastFntName{};
+    // we get multiple queries in a row; the font is
+    // modified below, so each thread needs its own copy
+    // in case several generators run in parallel
+    thread_local std::unique_ptr<QFont> fnt;
+    thread_local QString lastFntName{};
     if (!fnt || (lastFntName != fntName))
     {
       fnt = make_unique<QFont>(fntName);
@@ -1036,14 +1451,36 @@ namespace SimpleReportLib {
     fnt->setBold(isBold);
     //result->setItalic(isItalics());
 
+    QSizeF result_internalUnits = measureText__internalUnits(txt, *fnt);
+
+    // convert internal units to external units (mm) and return the result
+    return (result_internalUnits / ACCURACY_FAC);
+  }
+
+  //---------------------------------------------------------------------------
+
+  QSizeF SimpleReportGenerator::measureText__internalUnits(const QString& txt, const QFont& fnt)
+  {
+    QSizeF result;
+    if (textMetrics->lookup(fnt, txt, result)) return result;
+
     // add the text to the scene, determine the size and
     // immediately remove it
-    unique_ptr<QGraphicsSimpleTextItem> txtItem{curPagePtr->addSimpleText(txt, *fnt)};
-    QSizeF result_internalUnits = txtItem->boundingRect().size();
+    unique_ptr<QGraphicsSimpleTextItem> txtItem{curPagePtr->addSimpleText(txt, fnt)};
+    result = txtItem->boundingRect().size();
     curPagePtr->removeItem(txtItem.get());
 
-    // convert internal units to external units (mm) and return the result
-    return (result_internalUnits / ACCURACY_FAC);
+    textMetrics->insert(fnt, txt, result);
+    return result;
+  }
+
+  //---------------------------------------------------------------------------
+
+  void SimpleReportGenerator::setTextMetricsCache(shared_ptr<TextMetricsCache> cache)
+  {
+    if (cache == nullptr) return;
+
+    textMetrics = cache;
   }
 
   //---------------------------------------------------------------------------
@@ -1074,33 +1511,37 @@ namespace SimpleReportLib {
 
   //---------------------------------------------------------------------------
 
-  std::unique_ptr<QGraphicsSvgItem> SimpleReportGenerator::prepSvgItem(const string& svgContent)
+  std::unique_ptr<SvgItem> SimpleReportGenerator::prepSvgItem(const string& svgContent)
   {
-    // create a new, empty SVG renderer
-    auto upRenderer = make_unique<QSvgRenderer>();
-    if (!upRenderer) return nullptr;
-    auto renderer = upRenderer.get();
+    QByteArray rawSvg{svgContent.c_str(), static_cast<int>(svgContent.size())};
+
+    // repeated content (logos, watermarks, ...) is only validated and
+    // measured once; all items with the same content share the same data
+    // and the rendering threads parse it on demand
+    QByteArray contentHash = QCryptographicHash::hash(rawSvg, QCryptographicHash::Sha1);
+    auto it = svgSizeByHash.constFind(contentHash);
+    if (it != svgSizeByHash.constEnd())
+    {
+      return make_unique<SvgItem>(svgDataByHash.value(contentHash), contentHash, it.value());
+    }
 
     // try to load the provided data
-    QByteArray rawSvg{svgContent.c_str(), static_cast<int>(svgContent.size())};
-    if (!renderer->load(rawSvg))
+    QSvgRenderer renderer;
+    if (!(renderer.load(rawSvg)))
     {
       return nullptr;
     }
 
-    // loading was successful --> store the renderer in the renderer list
-    svgRenderers.push_back(std::move(upRenderer));
-
-    // create a SVG graphics item
-    auto svgItem = make_unique<QGraphicsSvgItem>();
-    svgItem->setSharedRenderer(renderer);
+    QSizeF defaultSize = renderer.defaultSize();
+    svgSizeByHash.insert(contentHash, defaultSize);
+    svgDataByHash.insert(contentHash, rawSvg);
 
-    return svgItem;
+    return make_unique<SvgItem>(rawSvg, contentHash, defaultSize);
   }
 
   //---------------------------------------------------------------------------
 
-  QRectF SimpleReportGenerator::addSVG(const QPointF& basePoint, RECT_CORNER basePointAlignment, std::unique_ptr<QGraphicsSvgItem> svgItem)
+  QRectF SimpleReportGenerator::addSVG(const QPointF& basePoint, RECT_CORNER basePointAlignment, std::unique_ptr<SvgItem> svgItem)
   {
     if (!curPagePtr) return QRectF{};
 
@@ -1125,6 +1566,17 @@ namespace SimpleReportLib {
 
   //---------------------------------------------------------------------------
 
+  bool SimpleReportGenerator::addGraphicsItem(std::unique_ptr<QGraphicsItem> item)
+  {
+    if (!curPagePtr) return false;
+    if (!item) return false;
+
+    curPagePtr->addItem(item.release());  // the scene takes ownership
+    return true;
+  }
+
+  //---------------------------------------------------------------------------
+
   double SimpleReportGenerator::lineType2Width__internalUnits(LINE_TYPE lt) const
   {
     double lineWidth = THIN_LINE_WIDTH__MM;
@@ -19,20 +19,30 @@
 #ifndef SIMPLEREPORTGENERATOR_H
 #define SIMPLEREPORTGENERATOR_H
 
+#include <functional>
+#include <mutex>
+
 #include <QPen>
 #include <QFont>
 #include <QHash>
+#include <QSet>
 #include <QGraphicsSimpleTextItem>
 #include <QGraphicsScene>
 #include <QStack>
 #include <QtSvg/QSvgRenderer>
-#include <QtSvg/QGraphicsSvgItem>
 
 //#include "simplereportgenerator_global.h"
 #include "TabSet.h"
 
 #include "TextStyle.h"
 #include "TextStyleLib.h"
+#include "ReportTextIndex.h"
+#include "ReportArchive.h"
+#include "PageImageExporter.h"
+#include "PdfExporter.h"
+#include "PictureItem.h"
+#include "SvgItem.h"
+#include "TextMetricsCache.h"
 
 using namespace std;
 
@@ -52,6 +62,9 @@ namespace SimpleReportLib {
 
   static constexpr double ACCURACY_FAC = 50.0;
 
+  // the QGraphicsItem::data() key that holds a hash of an SVG item's content
+  static constexpr int ITEM_DATA__SVG_CONTENT_HASH = 0;
+
   enum HOR_TXT_ALIGNMENT {
     LEFT,
     CENTER,
@@ -113,6 +126,11 @@ namespace SimpleReportLib {
     QString fr;
   };
 
+  class SimpleReportGenerator;
+
+  /** \brief A part of a report that is laid out on demand, see SimpleReportGenerator::addSection() */
+  using ReportSection = std::function<void(SimpleReportGenerator&)>;
+
   class SimpleReportGenerator
   {
 
@@ -122,14 +140,107 @@ namespace SimpleReportLib {
     SimpleReportGenerator(double _w, double _h, double _margin);
     //SimpleReportGenerator(const SimpleReportGenerator& orig);
     virtual ~SimpleReportGenerator();
+
+    /** \brief Creates a new, empty generator with the same configuration as this one
+     *
+     * Copies the page geometry, the pens, the text styles (including custom child
+     * styles), the tab set and tab stack and the global header and footer. The
+     * clone gets its own copy of the recorded master page, so that it can be used
+     * on another thread than the original; the thread-safe text metrics cache is
+     * shared with the clone.
+     *
+     * Pages, per-page headers and footers, the text index and pending sections
+     * are not copied.
+     */
+    std::unique_ptr<SimpleReportGenerator> cloneConfiguration() const;
     //void deleteAllPages();
 
     void startNextPage();
     int getPageCount();
+
+    /** \brief Redirects all subsequent drawing calls to the master page
+     *
+     * The master page holds the static content that is identical on all pages
+     * (logos, frames, background lines, ...). It is recorded only once by
+     * endMasterPage() and then referenced by every page that is started afterwards.
+     * SVG images are the exception: they are added to each page as separate items
+     * on top of the recorded content, so that exporters can detect them as repeated
+     * content (see PdfExporter).
+     *
+     * Only use the free positioning functions (drawText(), drawLine(), addSVG(), ...)
+     * between beginMasterPage() and endMasterPage() because the cursor-based functions
+     * might have to start a new page.
+     */
+    void beginMasterPage();
+
+    /** \brief Finishes the master page and restores the current page as drawing target
+     *
+     * Pages that already exist are not affected.
+     */
+    void endMasterPage();
+
+    /** \brief Appends a section to the list of sections that are laid out on demand
+     *
+     * Instead of building the whole report upfront, the report can be described
+     * as an ordered list of sections. The sections are executed in the order
+     * they've been added, but only as far as pages are actually requested via
+     * layoutUntilPage(). Until all sections have been executed, getPageCount()
+     * only returns an estimate.
+     */
+    void addSection(const ReportSection& section);
+
+    /** \brief Executes pending sections until the requested page exists
+     *
+     * \returns `true` if the page exists afterwards
+     */
+    bool layoutUntilPage(int idxPage);
+
+    /** \brief Executes all pending sections */
+    void layoutAllSections();
+
+    /** \returns the number of pages that have actually been laid out; in contrast to getPageCount() this is never an estimate */
+    inline int getLaidOutPageCount() const { return pages.size(); }
+
+    /** \brief Appends a page that only consists of a pre-recorded picture
+     *
+     * Useful for pages that have been laid out by another generator; the
+     * cursor remains on the current page.
+     */
+    void appendPicturePage(
+        std::shared_ptr<const QPicture> pic   ///< the page content in internal units, must not be null
+        );
+
+    /** \brief Replaces the generator's own text measurement cache with a shared one
+     *
+     * Useful if many generators with the same fonts run in parallel, e.g. in a batch.
+     */
+    void setTextMetricsCache(std::shared_ptr<TextMetricsCache> cache);
+
+    /** \returns `true` if no sections are pending and thus getPageCount() is exact */
+    inline bool isPageCountFinal() const { return idxNextSection >= sections.size(); }
     bool setActivePage(int idxPage);
     //int getCurrentPageNumber() const;
+
+    /** \returns the scene of a page; pages of loaded reports are decoded on first access
+     *
+     * Decoding is thread-safe, but the scenes themselves are not; see releasePage().
+     */
     QGraphicsScene* getPage(int idxPage);
 
+    /** \brief Drops the decoded scene of a loaded report's page to save memory
+     *
+     * The scene is decoded again by the next getPage(). Only pages of loaded
+     * reports (see loadFromFile()) that haven't been modified through setActivePage()
+     * or headers and footers can be released; all other pages are the only copy
+     * of their content and are kept.
+     *
+     * No one may use the page's scene anymore; e.g., the viewer's render thread
+     * calls this while holding the scene lock of its tile cache.
+     *
+     * \returns `true` if the scene has been released
+     */
+    bool releasePage(int idxPage);
+
     void writeLine(QString txt, const QString& styleName=QString(), double skipAfter = 0.0, double skipBefore = 0.0);
     void writeLine(QString txt, TextStyle* style, double skipAfter = 0.0, double skipBefore = 0.0);
     void skip(double skipAmount);
@@ -157,9 +268,11 @@ namespace SimpleReportLib {
 
     double getPageWidth();
     double getPageHeight();
+    double getMargin();
 
     double getUsablePageWidth() const;
     double getUsablePageHeight() const;
+    double getRemainingPageHeight() const;
 
     TextStyle* getTextStyle(const QString& styleName=QString()) const;
     TextStyle* createChildTextStyle(const QString &childName, const QString &parentName=QString());
@@ -235,6 +348,81 @@ namespace SimpleReportLib {
         double height_mm = 0.0   ///< proportionally scale the SVG to a given height (<= 0: use original size)
         );
 
+    /** \brief Adds an arbitrary, pre-configured graphics item to the current page
+     *
+     * The item's coordinates have to be in internal units (mm * ACCURACY_FAC).
+     *
+     * \returns false if there is no current page; the item is discarded in this case
+     */
+    bool addGraphicsItem(
+        std::unique_ptr<QGraphicsItem> item   ///< the item to be added (we take ownership)
+        );
+
+    /** \returns a pen for a given line type with the width in internal units
+     */
+    QPen lineType2Pen(LINE_TYPE lt, const QColor& penCol = QColor(Qt::black), Qt::PenStyle style = Qt::SolidLine) const;
+
+    /** \brief Searches all text that has been written to the report so far
+     *
+     * Pending sections (see addSection()) are not laid out by the search; call
+     * layoutAllSections() first to search the complete report.
+     *
+     * \returns the text runs that contain the query (case insensitive), with
+     * their page and bounding box in internal units
+     */
+    std::vector<ReportSearchHit> findText(
+        const QString& query   ///< one or more words; the last word may be incomplete
+        ) const;
+
+    /** \brief Saves all pages in a compact binary file that can be re-opened with loadFromFile()
+     *
+     * \returns false if the file couldn't be written
+     */
+    bool saveToFile(
+        const QString& fileName   ///< the name of the file to be created / overwritten
+        );
+
+    /** \brief Opens a report that has been saved with saveToFile()
+     *
+     * The file is memory mapped and the pages are only decoded when they're
+     * accessed for the first time (e.g., via getPage()), so that opening
+     * even very large reports is instant.
+     *
+     * \returns nullptr if the file is not a valid report file
+     */
+    static std::unique_ptr<SimpleReportGenerator> loadFromFile(
+        const QString& fileName   ///< the name of the file to be opened
+        );
+
+    /** \brief Renders all pages into image files ("page_<n>.<format>") using a pool of threads
+     *
+     * Rendering and encoding run concurrently; see PageImageExporter. The pages
+     * must not be accessed by other threads (e.g., a viewer) during the export.
+     *
+     * \returns the number of exported / failed pages and the throughput
+     */
+    ImageExportStats exportPagesAsImages(
+        const QString& dirName,   ///< the output directory, must exist
+        int dpi,   ///< the resolution of the images
+        const QString& format = "PNG",   ///< an image format supported by QImageWriter, e.g. "PNG" or "TIFF"
+        int nThreads = 0   ///< the total number of threads; 0 = number of cores
+        );
+
+    /** \brief Writes all pages as vector graphics to a PDF file
+     *
+     * By default, SVGs that occur on several pages (logos, watermarks, ...) are
+     * written as vector graphics on every page, so the file grows with the page
+     * count. Qt's PDF engine can't write vector content once and reference it from
+     * several pages. With PdfExportOptions::shareRepeatedSvgs, these SVGs are stored
+     * only once, as images with the PDF's resolution; see PdfExporter.
+     *
+     * \returns false if the file couldn't be written
+     */
+    bool exportPdf(
+        const QString& fileName,   ///< the name of the PDF file to be created / overwritten
+        const PdfExportOptions& options = PdfExportOptions()   ///< metadata, resolution and resource sharing
+        );
+
     // disable copy constructor, just for testing
     SimpleReportGenerator(const SimpleReportGenerator &orig) = delete;
 
@@ -257,14 +445,14 @@ namespace SimpleReportLib {
         );
 
   protected:
-    /** \brief Tries to parse the provided SVG data by instantiating a new SVG renderer; links the renderer
-     * to a new SVG graphics item if successful.
+    /** \brief Tries to parse the provided SVG data; creates a new SVG graphics item
+     * with the data if successful.
      *
      * The item is unmodified (no scaling, etc) and is not yet added to the scene.
      *
      * The caller has to take ownership of the item
      */
-    std::unique_ptr<QGraphicsSvgItem> prepSvgItem(
+    std::unique_ptr<SvgItem> prepSvgItem(
         const std::string& svgContent   ///< the SVG data to be rendered (NOT the file name or resource name!)
         );
 
@@ -275,10 +463,32 @@ namespace SimpleReportLib {
     QRectF addSVG(
         const QPointF& basePoint,   ///< the reference point for the insertion in external coordinates
         RECT_CORNER basePointAlignment,   ///< which relative point the reference coordinate denotes
-        std::unique_ptr<QGraphicsSvgItem> svgItem   ///< the SVG item to be added (we take ownership)
+        std::unique_ptr<SvgItem> svgItem   ///< the SVG item to be added (we take ownership)
         );
 
+    /** \brief Marks an archived page as modified so that releasePage() keeps it; call before decoding the page */
+    void pinPage(int idxPage);
+
   private:
+    // the layout state at the end of a section
+    struct LayoutCheckpoint
+    {
+      int idxCurPage;
+      double curY;
+      double maxY;
+      TabSet tabSet;
+      QStack<TabSet> tabStack;
+    };
+
+    // an SVG image on the master page
+    struct MasterSvg
+    {
+      QByteArray svgData;
+      QByteArray contentHash;
+      QSizeF defaultSize;
+      QTransform transform;   // item coordinates --> page coordinates
+    };
+
     QRectF setTextPosAligned(double x, double y, QGraphicsSimpleTextItem* txt, HOR_TXT_ALIGNMENT align=LEFT) const;
     double getTextHeightForStyle(const QString& styleName=QString(), const QString& sampleText=QString());
     void drawLine_internalUnits(double x0, double y0, double x1, double y1, LINE_TYPE lt=MED) const;
@@ -293,7 +503,15 @@ namespace SimpleReportLib {
     QRectF drawMultilineText__internalUnits(const QPointF& basePoint, RECT_CORNER basePointAlignment, const QStringList& lines, HOR_TXT_ALIGNMENT horAlign, double lineSpace, const TextStyle* style) const;
     void drawRect__internalUnits(const QRectF& rect, LINE_TYPE lt=MED, const QColor& fillColor = QColor(255, 255, 255)) const;
     double lineType2Width__internalUnits(LINE_TYPE lt) const;
-    QPen lineType2Pen(LINE_TYPE lt, const QColor& penCol = QColor(Qt::black), Qt::PenStyle style = Qt::SolidLine) const;
+    void indexTextItem(const QGraphicsSimpleTextItem* item, int idxPage = -1) const;
+    void ensureTextIndexLoaded() const;
+    std::vector<QGraphicsScene*> getAllPages();
+    void placeHeaderFooterText(QGraphicsSimpleTextItem* txtItem, int slot) const;
+    PictureItem* addSharedPicture(QGraphicsScene* sc, std::shared_ptr<const QPicture> pic, const std::vector<std::pair<QRectF, QString>>& textRuns, int idxPage) const;
+    std::unique_ptr<QGraphicsScene> createMasterScene() const;
+    void saveCheckpoint();
+    QSizeF measureText__internalUnits(const QString& txt, const QFont& fnt);
+    void restoreCheckpoint();
 
     double w;
     double h;
@@ -305,7 +523,8 @@ namespace SimpleReportLib {
     std::vector<std::unique_ptr<HeaderFooterStrings>> headerFooter;
     HeaderFooterStrings globalHeaderFooter;
 
-    std::vector<std::unique_ptr<QSvgRenderer>> svgRenderers;
+    QHash<QByteArray, QSizeF> svgSizeByHash;   // the natural size of each unique SVG content
+    QHash<QByteArray, QByteArray> svgDataByHash;   // one copy of the data per unique SVG content
 
     QPen thinPen;
     QPen mediumPen;
@@ -318,6 +537,33 @@ namespace SimpleReportLib {
 
     TextStyleLib styleLib;
 
+    std::shared_ptr<TextMetricsCache> textMetrics;   // may be shared with other generators
+
+    std::unique_ptr<ReportTextIndex> textIndex;   // all text runs, filled while text is added to the pages
+
+    std::unique_ptr<ReportArchive> archive;   // the source of pages that haven't been decoded yet (loaded reports only)
+    std::mutex archiveMutex;   // serializes decoding and releasing of archived pages
+    QSet<int> pinnedPages;   // archived pages that have been modified and thus can't be released; protected by archiveMutex
+    mutable bool isTextIndexLoaded{true};
+
+    // static page content that is recorded once and shared by all pages
+    std::unique_ptr<QGraphicsScene> masterScene;   // only non-null between beginMasterPage() and endMasterPage()
+    QGraphicsScene* curPageBeforeMaster{nullptr};
+    std::shared_ptr<const QPicture> masterPicture;
+    std::vector<std::pair<QRectF, QString>> masterTextRuns;
+    std::vector<MasterSvg> masterSvgs;   // drawn on top of the master picture
+
+    // the most recently used header / footer fields without page dependent tokens
+    QString sharedHeaderFooterKey;
+    std::shared_ptr<const QPicture> sharedHeaderFooterPicture;
+    std::vector<std::pair<QRectF, QString>> sharedHeaderFooterTextRuns;
+
+    // sections that are laid out on demand
+    std::vector<ReportSection> sections;
+    size_t idxNextSection{0};
+    std::unique_ptr<LayoutCheckpoint> checkpoint;   // the state after the most recently executed section
+    bool isLayoutRunning{false};   // sections must not trigger a nested layout
+
   };
 
 }
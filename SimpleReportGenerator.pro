@@ -4,56 +4,54 @@
 #
 #-------------------------------------------------
 
-QT       += widgets printsupport svg
-
-TARGET = SimpleReportGenerator
-
-CONFIG(debug, debug|release) {
-  TARGET = SimpleReportGeneratord
-}
-
-TEMPLATE = lib
-
-CONFIG += c++14 debug_and_release dll build_all
-
-VERSION = 0.3.2
-
-DEFINES += SIMPLEREPORTGENERATOR_LIBRARY
-
-SOURCES += SimpleReportGenerator.cpp \
-    TabSet.cpp \
-    TableWriter.cpp \
-    SimpleReportViewer.cpp \
-    TextStyle.cpp \
-    TextStyleLib.cpp \
-    ReportGraphicsView.cpp \
-    LineChart.cpp
-
-HEADERS += SimpleReportGenerator.h\
-        #simplereportgenerator_global.h \
-    TabSet.h \
-    TableWriter.h \
-    SimpleReportViewer.h \
-    TextStyle.h \
-    TextStyleLib.h \
-    ReportGraphicsView.h \
-    LineChart.h
-
-!unix {
-    target.path = D:/msys64/usr/local/lib
-    header_files.path = D:/msys64/usr/local/include/SimpleReportGeneratorLib
-    header_files.files = $$HEADERS
-    INSTALLS += header_files
-}
-
-unix {
-    target.path = /usr/local/lib
-    header_files.path = /usr/local/include/SimpleReportGeneratorLib
-    header_files.files = $$HEADERS
-    INSTALLS += header_files
-}
-
-INSTALLS += target
-
-FORMS += \
-    SimpleReportViewer.ui
+# The viewer and printing code is split off from the
+# rest of the library. Both libraries still depend on
+# QtWidgets because the pages are QGraphicsScenes:
+#
+#   * SimpleReportCore.pro: the layout engine and the exporters
+#     (lib "SimpleReportGenerator"); doesn't need QtPrintSupport
+#     and doesn't contain the viewer. Applications need a
+#     QApplication (on servers with "-platform offscreen")
+#
+#   * SimpleReportViewer.pro: the viewer and printing
+#     (lib "SimpleReportViewer"); links against the core
+#
+#   * reportgen.pro: a command line tool that renders
+#     JSON report descriptions headless; links against the core
+#
+#   * stresscheck.pro: lays out and exports reports from several
+#     threads at once and compares them with a single-threaded run;
+#     links against the core; not installed
+#
+# Applications that only generate and export reports
+# only need to link against the core library
+# (-lSimpleReportGenerator); applications with the viewer
+# have to link against both libraries
+# (-lSimpleReportViewer -lSimpleReportGenerator).
+#
+# Building and installing:
+#
+#   qmake SimpleReportGenerator.pro && make && make install
+#
+# installs both libraries to /usr/local/lib, their headers
+# to /usr/local/include/SimpleReportGeneratorLib and reportgen
+# to /usr/local/bin. Run "./stresscheck" from the build
+# directory to check the multi-threaded layout.
+
+TEMPLATE = subdirs
+
+SUBDIRS = core viewer reportgen stresscheck
+
+# all projects live in the same directory, so they
+# need distinct Makefiles
+core.file = SimpleReportCore.pro
+core.makefile = Makefile.core
+viewer.file = SimpleReportViewer.pro
+viewer.makefile = Makefile.viewer
+viewer.depends = core
+reportgen.file = reportgen.pro
+reportgen.makefile = Makefile.reportgen
+reportgen.depends = core
+stresscheck.file = stresscheck.pro
+stresscheck.makefile = Makefile.stresscheck
+stresscheck.depends = core
@@ -16,12 +16,17 @@
  *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
 #include <stdexcept>
 
 #include <QPrinter>
 #include <QPrintDialog>
 #include <QDebug>
 #include <QWheelEvent>
+#include <QSignalBlocker>
+#include <QScrollBar>
+#include <QMessageBox>
+#include <QToolTip>
 
 #include "SimpleReportViewer.h"
 #include "ui_SimpleReportViewer.h"
@@ -31,10 +36,27 @@ namespace SimpleReportLib {
 SimpleReportViewer::SimpleReportViewer(QWidget *parent) :
   QWidget(parent),
   ui(new Ui::SimpleReportViewer),
-  report(nullptr)
+  report(nullptr),
+  tileCache(new PageTileCache(this)),
+  thumbnailModel(new PageThumbnailModel(tileCache, this))
 {
   ui->setupUi(this);
 
+  // pages are rendered as tiles in the background and
+  // the view only paints the finished tiles
+  ui->gv->setTileCache(tileCache);
+
+  // the thumbnail list only requests the thumbnails of visible pages;
+  // when scrolling, requests for pages that went out of sight are dropped
+  ui->lvThumbnails->setModel(thumbnailModel);
+  ui->lvThumbnails->setViewMode(QListView::IconMode);
+  ui->lvThumbnails->setFlow(QListView::TopToBottom);
+  ui->lvThumbnails->setWrapping(false);
+  ui->lvThumbnails->setMovement(QListView::Static);
+  ui->lvThumbnails->setUniformItemSizes(true);
+  connect(ui->lvThumbnails, SIGNAL(clicked(QModelIndex)), this, SLOT(onThumbnailClicked(QModelIndex)));
+  connect(ui->lvThumbnails->verticalScrollBar(), SIGNAL(valueChanged(int)), this, SLOT(onThumbnailListScrolled()));
+
   ui->sbPage->setMaximum(42);  // dummy value, will be overwritten by setReport()
   //ui->sbPage->setValue(1);
 
@@ -43,6 +65,9 @@ SimpleReportViewer::SimpleReportViewer(QWidget *parent) :
   // connect signals and slots for view zoom factor changes
   connect(ui->gv, SIGNAL(viewZoomFactorChanged(int)), this, SLOT(onGraphicsViewZoomFactorChanged(int)), Qt::DirectConnection);
 
+  // in continuous mode, scrolling determines the current page
+  connect(ui->gv, SIGNAL(visiblePageChanged(int)), this, SLOT(onGraphicsViewVisiblePageChanged(int)), Qt::DirectConnection);
+
   // start with a default zoom factor of 100% (page fit)
   ui->gv->setZoomFactor(100);
 
@@ -53,6 +78,11 @@ SimpleReportViewer::SimpleReportViewer(QWidget *parent) :
 
 SimpleReportViewer::~SimpleReportViewer()
 {
+  // a running print job accesses the report and the
+  // tile cache, so we have to stop it first
+  stopPrintJob();
+  stopReportProducer();
+
   delete ui;
 }
 
@@ -60,17 +90,62 @@ SimpleReportViewer::~SimpleReportViewer()
 
 bool SimpleReportViewer::setReport(SimpleReportGenerator *r)
 {
+  stopReportProducer();
+
+  return activateReport(r);
+}
+
+//---------------------------------------------------------------------------
+
+bool SimpleReportViewer::setReportProgressive(SimpleReportGenerator* r)
+{
+  setReport(nullptr);
+  if (r == nullptr) return true;
+
+  // the report is laid out in the background; we start
+  // showing its pages as soon as the first one is ready
+  reportProducer = std::make_unique<ReportProducer>(r);
+  connect(reportProducer.get(), SIGNAL(pagesAvailable(int)), this, SLOT(onReportProducerPagesAvailable()));
+  connect(reportProducer.get(), SIGNAL(finished(bool,QString)), this, SLOT(onReportProducerFinished(bool,QString)), Qt::QueuedConnection);
+  reportProducer->start();
+  updateButtons();
+
+  return true;
+}
+
+//---------------------------------------------------------------------------
+
+bool SimpleReportViewer::activateReport(SimpleReportGenerator *r)
+{
+  // stop printing the old report
+  stopPrintJob();
+
   if (r == nullptr)
   {
     report = nullptr;
+    tileCache->setReport(nullptr);
+    lastSearchQuery.clear();
+    searchHits.clear();
+    ui->gv->clearHighlight();
+    thumbnailModel->setPages(0, QSizeF{});
     updateButtons();
     return true;
   }
 
+  // reports that are laid out on demand need at least
+  // the first pages before we can show anything
+  {
+    auto sceneLock = tileCache->lockScenes();
+    r->layoutUntilPage(1);
+  }
   if (r->getPageCount() == 0) return false;
 
   report = r;
-  ui->sbPage->setMaximum(report->getPageCount());
+  tileCache->setReport(r, getRecordedPages(r));
+  lastSearchQuery.clear();
+  searchHits.clear();
+  ui->gv->clearHighlight();
+  updatePageSetup();
   showPage(0);
   updateButtons();
 
@@ -82,33 +157,49 @@ bool SimpleReportViewer::setReport(SimpleReportGenerator *r)
 void SimpleReportViewer::refreshDisplayedContent()
 {
   if (report == nullptr) return;
-  showPage(curPage);
+
+  // the content might have changed, so all rendered tiles are obsolete
+  tileCache->setReport(report, getRecordedPages(report));
+  lastSearchQuery.clear();   // the next search has to re-query the report
+  updatePageSetup();
+  showPage(std::min(curPage, report->getPageCount() - 1));
 }
 
 //---------------------------------------------------------------------------
 
 void SimpleReportViewer::onBtnPrintClicked()
 {
-    QPrinter printer;
+    // only one print job at a time
+    if ((printJob != nullptr) || (report == nullptr)) return;
+
+    // printing requires the final page count; on-demand reports
+    // are laid out in the background first
+    if (!(report->isPageCountFinal()))
+    {
+      printWhenLaidOut();
+      return;
+    }
+
+    auto printer = std::make_unique<QPrinter>();
 
     // initialize the page ranges for the print dialog
     int numPages = report->getPageCount();
-    printer.setFromTo(1, numPages);
-    printer.setPrintRange(QPrinter::AllPages);
+    printer->setFromTo(1, numPages);
+    printer->setPrintRange(QPrinter::AllPages);
 
     // adjust the page orientation, depending
     // on our actual page size
     if (report->getPageWidth() > report->getPageHeight())
     {
-      printer.setPageOrientation(QPageLayout::Landscape);
+      printer->setPageOrientation(QPageLayout::Landscape);
     } else {
-      printer.setPageOrientation(QPageLayout::Portrait);
+      printer->setPageOrientation(QPageLayout::Portrait);
     }
 
-    if (QPrintDialog(&printer, this).exec() == QDialog::Accepted) {
+    if (QPrintDialog(printer.get(), this).exec() == QDialog::Accepted) {
       // get the page range from the printer dialog
-      int firstPage = printer.fromPage();
-      int lastPage = printer.toPage();
+      int firstPage = printer->fromPage();
+      int lastPage = printer->toPage();
 
       if (firstPage > 0)
       {
@@ -121,23 +212,228 @@ void SimpleReportViewer::onBtnPrintClicked()
         lastPage = numPages-1;
       }
 
-      // the actual printing
-      QPainter painter(&printer);
-      painter.setRenderHint(QPainter::Antialiasing);
-      for (int pg=firstPage; pg <= lastPage; ++pg)
-      {
-        QGraphicsScene* scene = report->getPage(pg);
-        scene->render(&painter);
-        if (pg != lastPage)
-        {
-          printer.newPage();
-        }
-      }
+      // the actual printing happens in the background
+      printJob = std::make_unique<PrintJob>(report, std::move(printer), firstPage, lastPage, tileCache);
+      connect(printJob.get(), SIGNAL(progress(int,int)), this, SLOT(onPrintJobProgress(int,int)), Qt::QueuedConnection);
+      connect(printJob.get(), SIGNAL(finished(bool)), this, SLOT(onPrintJobFinished()), Qt::QueuedConnection);
+
+      printProgress = new QProgressDialog(tr("Printing..."), tr("Cancel"), 0, printJob->getPageCount(), this);
+      printProgress->setWindowModality(Qt::WindowModal);
+      printProgress->setMinimumDuration(0);
+      printProgress->setValue(0);
+      connect(printProgress, SIGNAL(canceled()), printJob.get(), SLOT(cancel()));
+
+      ui->btnPrint->setEnabled(false);
+      printJob->start();
     }
 }
 
 //---------------------------------------------------------------------------
 
+void SimpleReportViewer::onPrintJobProgress(int donePages, int totalPages)
+{
+  if (printProgress == nullptr) return;
+
+  printProgress->setMaximum(totalPages);
+  printProgress->setValue(donePages);
+}
+
+//---------------------------------------------------------------------------
+
+void SimpleReportViewer::onPrintJobFinished()
+{
+  // the job's thread has emitted its last signal,
+  // so joining it doesn't block for long
+  stopPrintJob();
+  updateButtons();
+}
+
+//---------------------------------------------------------------------------
+
+void SimpleReportViewer::onBtnFindNextClicked()
+{
+  if (!(updateSearch()) || searchHits.empty()) return;
+
+  showSearchHit((curSearchHit + 1) % static_cast<int>(searchHits.size()));
+}
+
+//---------------------------------------------------------------------------
+
+void SimpleReportViewer::onBtnFindPrevClicked()
+{
+  if (!(updateSearch()) || searchHits.empty()) return;
+
+  int n = static_cast<int>(searchHits.size());
+  showSearchHit((curSearchHit < 1) ? (n - 1) : (curSearchHit - 1));
+}
+
+//---------------------------------------------------------------------------
+
+bool SimpleReportViewer::updateSearch()
+{
+  if (report == nullptr) return false;
+
+  // only query the report's text index if the query has changed;
+  // new pages reset the cached query (see layoutUntilPage())
+  QString query = ui->leSearch->text().simplified();
+  if (query == lastSearchQuery) return true;
+
+  lastSearchQuery = query;
+  searchHits = report->findText(query);
+  curSearchHit = -1;
+  ui->gv->clearHighlight();
+
+  // on-demand reports are only searched as far as they have been laid out;
+  // laying out the rest here would block the GUI for the whole report
+  if (!(report->isPageCountFinal()) && !(query.isEmpty()))
+  {
+    QString msg = tr("Only the first %1 pages have been searched; the remaining pages are searched once they have been shown.")
+                  .arg(report->getLaidOutPageCount());
+    QToolTip::showText(ui->leSearch->mapToGlobal(QPoint{0, ui->leSearch->height()}), msg, ui->leSearch);
+  }
+
+  return true;
+}
+
+//---------------------------------------------------------------------------
+
+void SimpleReportViewer::showSearchHit(int idxHit)
+{
+  if ((idxHit < 0) || (idxHit >= static_cast<int>(searchHits.size()))) return;
+
+  curSearchHit = idxHit;
+  const ReportSearchHit& hit = searchHits[idxHit];
+  showPage(hit.page);
+  ui->gv->setHighlight(hit.page, hit.box);
+}
+
+//---------------------------------------------------------------------------
+
+void SimpleReportViewer::onReportProducerPagesAvailable()
+{
+  if (reportProducer == nullptr) return;
+
+  // the first page replaces the empty view; after
+  // that, we only have to extend the page range
+  SimpleReportGenerator* preview = reportProducer->getPreview();
+  if (layoutProgress != nullptr)
+  {
+    layoutProgress->setLabelText(tr("Preparing the report for printing...\n\n%1 pages done").arg(preview->getPageCount()));
+  }
+  if (report != preview)
+  {
+    activateReport(preview);
+    return;
+  }
+
+  // the tile cache renders the preview from its recorded pages
+  tileCache->setPicturePages(reportProducer->getRecordedPages());
+  updatePageSetup();
+  updateButtons();
+}
+
+//---------------------------------------------------------------------------
+
+void SimpleReportViewer::onReportProducerFinished(bool wasCancelled, const QString& errMsg)
+{
+  // ignore late signals from producers that we've already stopped
+  if ((reportProducer == nullptr) || (sender() != reportProducer.get())) return;
+
+  // switch from the recorded preview to the complete report;
+  // the preview has to live until the tile cache has switched, too
+  std::unique_ptr<ReportProducer> producer = std::move(reportProducer);
+  const int pg = curPage;
+  const bool isPrintRequested = (layoutProgress != nullptr);
+  closeLayoutProgress();
+  if (!(errMsg.isEmpty()))
+  {
+    activateReport(nullptr);
+    QMessageBox::critical(this, tr("Report"), tr("The report could not be created:\n\n%1").arg(errMsg));
+    return;
+  }
+
+  // a cancelled layout leaves the report as far as it has been laid out;
+  // the remaining sections are executed on demand as before
+  if (!(activateReport(producer->getReport())))
+  {
+    activateReport(nullptr);
+    return;
+  }
+  showPage(std::max(0, std::min(pg, report->getPageCount() - 1)));
+
+  if (isPrintRequested && !wasCancelled) onBtnPrintClicked();
+}
+
+//---------------------------------------------------------------------------
+
+void SimpleReportViewer::stopReportProducer()
+{
+  if (reportProducer == nullptr) return;
+
+  closeLayoutProgress();
+
+  // the preview is owned by the producer
+  if (report == reportProducer->getPreview()) activateReport(nullptr);
+
+  // cancels and joins the layout thread
+  reportProducer.reset();
+}
+
+//---------------------------------------------------------------------------
+
+std::shared_ptr<const PicturePageList> SimpleReportViewer::getRecordedPages(SimpleReportGenerator* r) const
+{
+  // only the preview of a running producer has recorded pages
+  if ((reportProducer == nullptr) || (r != reportProducer->getPreview())) return nullptr;
+
+  return reportProducer->getRecordedPages();
+}
+
+//---------------------------------------------------------------------------
+
+void SimpleReportViewer::printWhenLaidOut()
+{
+  if ((report == nullptr) || (reportProducer != nullptr)) return;
+
+  // the remaining sections are executed by a producer, as for
+  // progressive reports; the viewer shows the pages meanwhile
+  // and the print dialog opens as soon as the layout is complete
+  setReportProgressive(report);
+
+  layoutProgress = new QProgressDialog(tr("Preparing the report for printing..."), tr("Cancel"), 0, 0, this);
+  layoutProgress->setWindowModality(Qt::WindowModal);
+  layoutProgress->setMinimumDuration(0);
+  connect(layoutProgress, SIGNAL(canceled()), reportProducer.get(), SLOT(cancel()));
+}
+
+//---------------------------------------------------------------------------
+
+void SimpleReportViewer::closeLayoutProgress()
+{
+  if (layoutProgress == nullptr) return;
+
+  // don't trigger canceled() while closing
+  layoutProgress->disconnect();
+  layoutProgress->deleteLater();
+  layoutProgress = nullptr;
+}
+
+//---------------------------------------------------------------------------
+
+void SimpleReportViewer::stopPrintJob()
+{
+  // cancels and joins a running job
+  printJob.reset();
+
+  if (printProgress != nullptr)
+  {
+    printProgress->deleteLater();
+    printProgress = nullptr;
+  }
+}
+
+//---------------------------------------------------------------------------
+
 void SimpleReportViewer::onBtnPageNextClicked()
 {
   showNextPage();
@@ -157,12 +453,22 @@ bool SimpleReportViewer::showPage(int pgNum)
   if (report == nullptr) return false;
 
   if (pgNum < 0) return false;
+  layoutUntilPage(pgNum + 1);   // including the page for prefetching
   if (pgNum >= report->getPageCount()) return false;
 
-  ui->gv->setScene(report->getPage(pgNum));
-  ui->gv->recalcZoom();
   curPage = pgNum;
+  ui->gv->showCachedPage(pgNum);
   updateButtons();
+
+  // prepare the neighboring pages in the background
+  // so that page turns only need to blit the tiles;
+  // in continuous mode, the view takes care of that while scrolling
+  if (!ui->gv->isContinuousMode())
+  {
+    if ((pgNum + 1) < report->getPageCount()) ui->gv->prefetchPage(pgNum + 1);
+    if (pgNum > 0) ui->gv->prefetchPage(pgNum - 1);
+  }
+
   return true;
 }
 
@@ -173,9 +479,16 @@ void SimpleReportViewer::updateButtons()
   bool isEnabled = (report != nullptr);
   ui->btnPageNext->setEnabled(isEnabled);
   ui->btnPagePrev->setEnabled(isEnabled);
-  ui->btnPrint->setEnabled(isEnabled);
+  // printing and searching require the complete report
+  const bool isComplete = (reportProducer == nullptr);
+  ui->btnPrint->setEnabled(isEnabled && isComplete && (printJob == nullptr));
   ui->btnZoomLess->setEnabled(isEnabled);
   ui->btnZoomMore->setEnabled(isEnabled);
+  ui->btnContinuous->setEnabled(isEnabled);
+  ui->lvThumbnails->setEnabled(isEnabled);
+  ui->leSearch->setEnabled(isEnabled && isComplete);
+  ui->btnFindPrev->setEnabled(isEnabled && isComplete);
+  ui->btnFindNext->setEnabled(isEnabled && isComplete);
   ui->sbPage->setEnabled(isEnabled);
   ui->zoomSlider->setEnabled(isEnabled);
   ui->gv->setEnabled(isEnabled);
@@ -185,6 +498,42 @@ void SimpleReportViewer::updateButtons()
   ui->btnPageNext->setEnabled(curPage < (report->getPageCount() - 1));
   ui->btnPagePrev->setEnabled(curPage > 0);
   ui->sbPage->setValue(curPage + 1);
+  ui->lvThumbnails->setCurrentIndex(thumbnailModel->index(curPage));
+}
+
+//---------------------------------------------------------------------------
+
+void SimpleReportViewer::updatePageSetup()
+{
+  int nPages = report->getPageCount();
+  QSizeF pageSize{report->getPageWidth() * ACCURACY_FAC, report->getPageHeight() * ACCURACY_FAC};
+
+  ui->gv->setCachedPages(nPages, pageSize);
+  ui->sbPage->setMaximum(nPages);
+
+  thumbnailModel->setPages(nPages, pageSize);
+  ui->lvThumbnails->setIconSize(thumbnailModel->getThumbnailSize());
+}
+
+//---------------------------------------------------------------------------
+
+void SimpleReportViewer::layoutUntilPage(int pgNum)
+{
+  if ((report == nullptr) || report->isPageCountFinal()) return;
+
+  // the render threads must not access the
+  // pages while new pages are being added
+  const int oldPageCount = report->getPageCount();
+  const int oldLaidOutCount = report->getLaidOutPageCount();
+  {
+    auto sceneLock = tileCache->lockScenes();
+    report->layoutUntilPage(pgNum);
+  }
+
+  // the page count is an estimate until the last page has been laid out;
+  // search results that have been cached before are incomplete
+  if (report->getPageCount() != oldPageCount) updatePageSetup();
+  if (report->getLaidOutPageCount() != oldLaidOutCount) lastSearchQuery.clear();
 }
 
 //---------------------------------------------------------------------------
@@ -253,6 +602,51 @@ void SimpleReportViewer::onGraphicsViewZoomFactorChanged(int newZoomFactor)
 
 //---------------------------------------------------------------------------
 
+void SimpleReportViewer::setContinuousScrollMode(bool isContinuous)
+{
+  // the button's toggled() signal does the actual work
+  ui->btnContinuous->setChecked(isContinuous);
+}
+
+//---------------------------------------------------------------------------
+
+void SimpleReportViewer::onBtnContinuousToggled(bool isChecked)
+{
+  ui->gv->setContinuousMode(isChecked);
+}
+
+//---------------------------------------------------------------------------
+
+void SimpleReportViewer::onGraphicsViewVisiblePageChanged(int pg)
+{
+  if (report == nullptr) return;
+
+  // only update the page controls; calling showPage()
+  // would scroll the view back to the top of the page
+  layoutUntilPage(pg + 1);
+  curPage = pg;
+  QSignalBlocker blocker{ui->sbPage};
+  updateButtons();
+}
+
+//---------------------------------------------------------------------------
+
+void SimpleReportViewer::onThumbnailClicked(const QModelIndex& idx)
+{
+  if (idx.isValid()) showPage(idx.row());
+}
+
+//---------------------------------------------------------------------------
+
+void SimpleReportViewer::onThumbnailListScrolled()
+{
+  // the repaint after scrolling re-requests all
+  // thumbnails that are still / now visible
+  tileCache->cancelPendingThumbnails();
+}
+
+//---------------------------------------------------------------------------
+
 void SimpleReportViewer::wheelEvent(QWheelEvent* ev)
 {
   // ignore / propagate all wheel events without Ctrl-key
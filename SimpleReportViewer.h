@@ -19,10 +19,17 @@
 #ifndef SIMPLEREPORTVIEWER_H
 #define SIMPLEREPORTVIEWER_H
 
+#include <memory>
+
 #include <QWidget>
+#include <QProgressDialog>
 
 //#include "simplereportgenerator_global.h"
 #include "SimpleReportGenerator.h"
+#include "PageTileCache.h"
+#include "PageThumbnailModel.h"
+#include "PrintJob.h"
+#include "ReportProducer.h"
 
 namespace Ui {
   class SimpleReportViewer;
@@ -44,7 +51,9 @@ public:
   bool showPrevPage();
   bool showPage(int pgNum);
   bool setReport(SimpleReportGenerator* r);
+  bool setReportProgressive(SimpleReportGenerator* r);
   void refreshDisplayedContent();
+  void setContinuousScrollMode(bool isContinuous);
 
 public slots:
   void onBtnPrintClicked();
@@ -55,6 +64,16 @@ public slots:
   void onBtnZoomLessClicked();
   void onSpinBoxPageChanged();
   void onGraphicsViewZoomFactorChanged(int newZoomFactor);
+  void onBtnContinuousToggled(bool isChecked);
+  void onGraphicsViewVisiblePageChanged(int pg);
+  void onThumbnailClicked(const QModelIndex& idx);
+  void onThumbnailListScrolled();
+  void onPrintJobProgress(int donePages, int totalPages);
+  void onPrintJobFinished();
+  void onReportProducerPagesAvailable();
+  void onReportProducerFinished(bool wasCancelled, const QString& errMsg);
+  void onBtnFindNextClicked();
+  void onBtnFindPrevClicked();
   virtual void wheelEvent(QWheelEvent* ev) override;
 
 protected:
@@ -63,8 +82,27 @@ protected:
 private:
   Ui::SimpleReportViewer *ui;
   SimpleReportGenerator* report;
+  PageTileCache* tileCache;   // owned by Qt's parent-child-relationship
+  PageThumbnailModel* thumbnailModel;   // owned by Qt's parent-child-relationship
+  std::unique_ptr<PrintJob> printJob;
+  std::unique_ptr<ReportProducer> reportProducer;
+  QProgressDialog* printProgress{nullptr};   // owned by Qt's parent-child-relationship
+  QProgressDialog* layoutProgress{nullptr};   // non-null while a report is laid out for printing
+  std::vector<ReportSearchHit> searchHits;
+  QString lastSearchQuery;
+  int curSearchHit{-1};
   int curPage = -1;
   void updateButtons();
+  void updatePageSetup();
+  void layoutUntilPage(int pgNum);
+  void stopPrintJob();
+  void stopReportProducer();
+  void printWhenLaidOut();
+  void closeLayoutProgress();
+  bool activateReport(SimpleReportGenerator* r);
+  std::shared_ptr<const PicturePageList> getRecordedPages(SimpleReportGenerator* r) const;
+  bool updateSearch();
+  void showSearchHit(int idxHit);
 };
 
 }
@@ -0,0 +1,46 @@
+#-------------------------------------------------
+#
+# The interactive viewer and printing;
+# links against the core library
+#
+#-------------------------------------------------
+
+QT       += widgets printsupport svg
+
+TARGET = SimpleReportViewer
+
+CONFIG(debug, debug|release) {
+  TARGET = SimpleReportViewerd
+}
+
+TEMPLATE = lib
+
+# the core library is built into the same directory
+win32:CONFIG(debug, debug|release): LIBS += -L$$OUT_PWD/debug
+win32:CONFIG(release, debug|release): LIBS += -L$$OUT_PWD/release
+LIBS += -L$$OUT_PWD
+
+CONFIG(debug, debug|release) {
+  LIBS += -lSimpleReportGeneratord
+} else {
+  LIBS += -lSimpleReportGenerator
+}
+
+SOURCES += SimpleReportViewer.cpp \
+    ReportGraphicsView.cpp \
+    PageTileCache.cpp \
+    PageThumbnailModel.cpp \
+    PrintJob.cpp \
+    ReportProducer.cpp
+
+HEADERS += SimpleReportViewer.h \
+    ReportGraphicsView.h \
+    PageTileCache.h \
+    PageThumbnailModel.h \
+    PrintJob.h \
+    ReportProducer.h
+
+FORMS += \
+    SimpleReportViewer.ui
+
+include(SimpleReportCommon.pri)
@@ -0,0 +1,93 @@
+/*
+ *    This is SimpleReportGenerator, a very basic report generator on top of Qt.
+ *    Copyright (C) 2014 - 2015  Volker Knollmann
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdexcept>
+
+#include <QCache>
+#include <QPainter>
+
+#include "SvgItem.h"
+#include "SimpleReportGenerator.h"
+
+namespace SimpleReportLib {
+
+  SvgItem::SvgItem(const QByteArray& _svgData, const QByteArray& _contentHash, const QSizeF& _defaultSize)
+    :QGraphicsItem(), svgData(_svgData), contentHash(_contentHash), defaultSize(_defaultSize)
+  {
+    if (svgData.isEmpty() || contentHash.isEmpty())
+    {
+      throw std::invalid_argument("Invalid parameters for SvgItem ctor!");
+    }
+
+    // exporters use the hash to identify repeated content
+    setData(ITEM_DATA__SVG_CONTENT_HASH, contentHash);
+  }
+
+  //----------------------------------------------------------------------------
+
+  QRectF SvgItem::boundingRect() const
+  {
+    return QRectF{QPointF{0, 0}, defaultSize};
+  }
+
+  //----------------------------------------------------------------------------
+
+  void SvgItem::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget)
+  {
+    Q_UNUSED(option);
+    Q_UNUSED(widget);
+
+    render(painter, boundingRect());
+  }
+
+  //----------------------------------------------------------------------------
+
+  void SvgItem::render(QPainter* painter, const QRectF& target) const
+  {
+    QSvgRenderer* renderer = getThreadRenderer();
+    if (renderer == nullptr) return;
+
+    renderer->render(painter, target);
+  }
+
+  //----------------------------------------------------------------------------
+
+  QSvgRenderer* SvgItem::getThreadRenderer() const
+  {
+    // QSvgRenderer is not thread-safe, so each thread parses
+    // the content on its own; repeated content is only parsed
+    // once per thread
+    thread_local QCache<QByteArray, QSvgRenderer> renderers{MAX_RENDERERS_PER_THREAD};
+
+    QSvgRenderer* renderer = renderers.object(contentHash);
+    if (renderer != nullptr) return renderer;
+
+    renderer = new QSvgRenderer{};
+    if (!(renderer->load(svgData)))
+    {
+      delete renderer;
+      return nullptr;
+    }
+    renderers.insert(contentHash, renderer);   // the cache takes ownership
+
+    return renderer;
+  }
+
+  //----------------------------------------------------------------------------
+
+}
@@ -0,0 +1,73 @@
+/*
+ *    This is SimpleReportGenerator, a very basic report generator on top of Qt.
+ *    Copyright (C) 2014 - 2015  Volker Knollmann
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SVGITEM_H
+#define SVGITEM_H
+
+#include <QByteArray>
+#include <QGraphicsItem>
+#include <QSizeF>
+#include <QtSvg/QSvgRenderer>
+
+namespace SimpleReportLib {
+
+  /** \brief A graphics item that draws SVG data
+   *
+   * In contrast to QGraphicsSvgItem, the item doesn't reference a
+   * QSvgRenderer but only the (implicitly shared) SVG data. The data is
+   * parsed by one renderer per thread and content, so that pages with
+   * the same SVG content can be rendered by several threads at once.
+   */
+  class SvgItem : public QGraphicsItem
+  {
+  public:
+    /** \brief the max. number of renderers that are cached per thread */
+    static constexpr int MAX_RENDERERS_PER_THREAD = 50;
+
+    SvgItem(
+        const QByteArray& _svgData,   ///< the SVG data, must be valid
+        const QByteArray& _contentHash,   ///< a hash of the SVG data that identifies the content
+        const QSizeF& _defaultSize   ///< the SVG's natural size, see QSvgRenderer::defaultSize()
+        );
+
+    /** \brief the item type for qgraphicsitem_cast() */
+    enum { Type = UserType + 1 };
+    virtual int type() const override { return Type; }
+
+    virtual QRectF boundingRect() const override;
+    virtual void paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget) override;
+
+    /** \brief Renders the SVG content into an arbitrary rectangle, e.g., of an image */
+    void render(QPainter* painter, const QRectF& target) const;
+
+    inline const QByteArray& getSvgData() const { return svgData; }
+    inline const QByteArray& getContentHash() const { return contentHash; }
+    inline const QSizeF& getDefaultSize() const { return defaultSize; }
+
+  protected:
+    /** \returns the calling thread's renderer for the content or nullptr if the data is invalid */
+    QSvgRenderer* getThreadRenderer() const;
+
+    QByteArray svgData;
+    QByteArray contentHash;
+    QSizeF defaultSize;
+  };
+
+}
+
+#endif // SVGITEM_H
@@ -0,0 +1,70 @@
+/*
+ *    This is SimpleReportGenerator, a very basic report generator on top of Qt.
+ *    Copyright (C) 2014 - 2015  Volker Knollmann
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <mutex>
+
+#include "TextMetricsCache.h"
+
+namespace SimpleReportLib {
+
+  constexpr int TextMetricsCache::MAX_ENTRIES;
+
+  //----------------------------------------------------------------------------
+
+  bool TextMetricsCache::lookup(const QFont& fnt, const QString& txt, QSizeF& result) const
+  {
+    const QString key = makeKey(fnt, txt);
+
+    std::shared_lock<std::shared_timed_mutex> lock{mutex};
+    auto it = sizes.constFind(key);
+    if (it == sizes.constEnd()) return false;
+
+    result = it.value();
+    return true;
+  }
+
+  //----------------------------------------------------------------------------
+
+  void TextMetricsCache::insert(const QFont& fnt, const QString& txt, const QSizeF& sz)
+  {
+    const QString key = makeKey(fnt, txt);
+
+    std::unique_lock<std::shared_timed_mutex> lock{mutex};
+    if (sizes.size() >= MAX_ENTRIES) return;
+    sizes.insert(key, sz);
+  }
+
+  //----------------------------------------------------------------------------
+
+  int TextMetricsCache::getEntryCount() const
+  {
+    std::shared_lock<std::shared_timed_mutex> lock{mutex};
+    return sizes.size();
+  }
+
+  //----------------------------------------------------------------------------
+
+  QString TextMetricsCache::makeKey(const QFont& fnt, const QString& txt)
+  {
+    // the font key covers family, size, weight and style
+    return fnt.key() + QChar('\n') + txt;
+  }
+
+  //----------------------------------------------------------------------------
+
+}
@@ -0,0 +1,69 @@
+/*
+ *    This is SimpleReportGenerator, a very basic report generator on top of Qt.
+ *    Copyright (C) 2014 - 2015  Volker Knollmann
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TEXTMETRICSCACHE_H
+#define TEXTMETRICSCACHE_H
+
+#include <shared_mutex>
+
+#include <QFont>
+#include <QHash>
+#include <QSizeF>
+#include <QString>
+
+namespace SimpleReportLib {
+
+  /** \brief A thread-safe cache for the dimensions of text runs
+   *
+   * Measuring text is deterministic for a given font and text, so the
+   * results can be shared between several generators, even if they run
+   * on different threads. Lookups only take a shared lock; the cache is
+   * mostly read once the common texts (headers, labels, ...) have been
+   * measured.
+   */
+  class TextMetricsCache
+  {
+  public:
+    /** \brief the max. number of cached measurements; further measurements are not cached */
+    static constexpr int MAX_ENTRIES = 100000;
+
+    /** \brief Looks up the dimensions of a text in internal units
+     *
+     * \returns `true` if the text has been measured before
+     */
+    bool lookup(
+        const QFont& fnt,   ///< the font used for the text
+        const QString& txt,   ///< the text
+        QSizeF& result   ///< receives the dimensions if found
+        ) const;
+
+    /** \brief Stores the dimensions of a text in internal units */
+    void insert(const QFont& fnt, const QString& txt, const QSizeF& sz);
+
+    int getEntryCount() const;
+
+  protected:
+    static QString makeKey(const QFont& fnt, const QString& txt);
+
+    mutable std::shared_timed_mutex mutex;   // protects the hash
+    QHash<QString, QSizeF> sizes;
+  };
+
+}
+
+#endif // TEXTMETRICSCACHE_H
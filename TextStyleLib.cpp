@@ -31,6 +31,45 @@ TextStyleLib::TextStyleLib()
 
 //---------------------------------------------------------------------------
 
+TextStyleLib::TextStyleLib(const TextStyleLib& other)
+  :TextStyleLib()
+{
+  *this = other;
+}
+
+//---------------------------------------------------------------------------
+
+TextStyleLib& TextStyleLib::operator=(const TextStyleLib& other)
+{
+  if (this == &other) return *this;
+
+  // copy all styles first; a child's parent might
+  // come after the child in the alphabetical order
+  std::map<const TextStyle*, TextStyle*> old2new;
+  root = copyStyle(*(other.root));
+  old2new[other.root.get()] = root.get();
+
+  name2style.clear();
+  for (const auto& entry : other.name2style)
+  {
+    upTextStyle newStyle = copyStyle(*(entry.second));
+    old2new[entry.second.get()] = newStyle.get();
+    name2style[entry.first] = std::move(newStyle);
+  }
+
+  // link the copies to their new parents
+  for (const auto& entry : other.name2style)
+  {
+    const TextStyle* oldParent = entry.second->parent;
+    if (oldParent == nullptr) continue;
+    name2style[entry.first]->parent = old2new.at(oldParent);
+  }
+
+  return *this;
+}
+
+//---------------------------------------------------------------------------
+
 TextStyle* TextStyleLib::getStyle(const QString& styleName) const
 {
   // root has no name
@@ -74,6 +113,21 @@ TextStyle* TextStyleLib::createChildStyle(const QString& childName, const QStrin
 
 //---------------------------------------------------------------------------
 
+upTextStyle TextStyleLib::copyStyle(const TextStyle& src)
+{
+  upTextStyle result{new TextStyle()};
+  result->fontName = src.fontName;
+  result->fontSize_MM = src.fontSize_MM;
+  result->boldState = src.boldState;
+  result->italicsState = src.italicsState;
+  result->fontColor.reset((src.fontColor == nullptr) ? nullptr : new QColor(*(src.fontColor)));
+  result->parent = nullptr;   // set by the caller
+
+  return result;
+}
+
+//---------------------------------------------------------------------------
+
 
 //---------------------------------------------------------------------------
 //---------------------------------------------------------------------------
@@ -34,10 +34,17 @@ class TextStyleLib
 public:
   TextStyleLib();
 
+  // deep copies; the parent relationships are
+  // mapped to the styles of the new lib
+  TextStyleLib(const TextStyleLib& other);
+  TextStyleLib& operator=(const TextStyleLib& other);
+
   TextStyle* getStyle(const QString &styleName=QString()) const;
   TextStyle* createChildStyle(const QString &childName, const QString &parentName=QString());
 
 private:
+  static upTextStyle copyStyle(const TextStyle& src);
+
   std::map<QString, upTextStyle> name2style;
   upTextStyle root;
 };
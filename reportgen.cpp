@@ -0,0 +1,212 @@
+/*
+ *    This is SimpleReportGenerator, a very basic report generator on top of Qt.
+ *    Copyright (C) 2014 - 2015  Volker Knollmann
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * reportgen: renders declarative report descriptions (see JsonReportBuilder)
+ * into PDF files or PNG images without a display.
+ *
+ * Usage:
+ *   reportgen [options] <job.json | directory>
+ *
+ * If a directory is given, all *.json files in it are processed in parallel.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QFileInfo>
+
+#include "SimpleReportGenerator.h"
+#include "JsonReportBuilder.h"
+
+using namespace SimpleReportLib;
+
+namespace {
+
+  struct JobSettings
+  {
+    QString format;   // "pdf" or "png"
+    int dpi;
+    QString outDir;   // empty: next to the job file
+  };
+
+  std::mutex consoleMutex;
+
+  //----------------------------------------------------------------------------
+
+  void printMessage(const QString& msg)
+  {
+    std::lock_guard<std::mutex> lock{consoleMutex};
+    fprintf(stderr, "%s\n", qPrintable(msg));
+  }
+
+  //----------------------------------------------------------------------------
+
+  bool runJob(const QString& jobFile, const JobSettings& settings, int nExportThreads)
+  {
+    QString errMsg;
+    auto builder = JsonReportBuilder::fromFile(jobFile, &errMsg);
+    if (builder == nullptr)
+    {
+      printMessage(errMsg);
+      return false;
+    }
+
+    std::unique_ptr<SimpleReportGenerator> report;
+    try
+    {
+      report = builder->createReport();
+    }
+    catch (std::exception& ex)
+    {
+      printMessage(jobFile + ": " + ex.what());
+      return false;
+    }
+
+    // the output is named after the job file
+    QFileInfo jobInfo{jobFile};
+    QDir outDir{settings.outDir.isEmpty() ? jobInfo.absolutePath() : settings.outDir};
+    const QString baseName = jobInfo.completeBaseName();
+
+    if (settings.format == "pdf")
+    {
+      PdfExportOptions opt;
+      opt.title = baseName;
+      opt.creator = "reportgen";
+      QString outFile = outDir.absoluteFilePath(baseName + ".pdf");
+      if (!(report->exportPdf(outFile, opt)))
+      {
+        printMessage(jobFile + ": can't write " + outFile);
+        return false;
+      }
+      return true;
+    }
+
+    // images go into a directory per job
+    if (!(outDir.mkpath(baseName)))
+    {
+      printMessage(jobFile + ": can't create " + outDir.absoluteFilePath(baseName));
+      return false;
+    }
+    ImageExportStats stats = report->exportPagesAsImages(outDir.absoluteFilePath(baseName), settings.dpi, "PNG", nExportThreads);
+    if (stats.failedPages > 0)
+    {
+      printMessage(QString("%1: %2 page(s) could not be exported").arg(jobFile).arg(stats.failedPages));
+      return false;
+    }
+
+    return true;
+  }
+
+}
+
+//----------------------------------------------------------------------------
+
+int main(int argc, char* argv[])
+{
+  // the scenes need a QApplication, but no display
+  if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) qputenv("QT_QPA_PLATFORM", "offscreen");
+
+  QApplication app{argc, argv};
+  QApplication::setApplicationName("reportgen");
+
+  QCommandLineParser parser;
+  parser.setApplicationDescription("Renders JSON report descriptions into PDF files or PNG images");
+  parser.addHelpOption();
+  parser.addPositionalArgument("input", "A JSON job file or a directory with JSON job files");
+  QCommandLineOption formatOption{QStringList{"f", "format"}, "Output format: pdf or png (default: pdf)", "format", "pdf"};
+  QCommandLineOption dpiOption{"dpi", "Resolution for PNG output (default: 150)", "dpi", "150"};
+  QCommandLineOption outOption{QStringList{"o", "output"}, "Output directory (default: next to the job file)", "dir"};
+  QCommandLineOption jobsOption{QStringList{"j", "jobs"}, "Number of parallel jobs (default: number of cores)", "n", "0"};
+  parser.addOption(formatOption);
+  parser.addOption(dpiOption);
+  parser.addOption(outOption);
+  parser.addOption(jobsOption);
+  parser.process(app);
+
+  if (parser.positionalArguments().size() != 1) parser.showHelp(1);
+
+  JobSettings settings;
+  settings.format = parser.value(formatOption).toLower();
+  settings.dpi = parser.value(dpiOption).toInt();
+  settings.outDir = parser.value(outOption);
+  if (((settings.format != "pdf") && (settings.format != "png")) || (settings.dpi <= 0))
+  {
+    parser.showHelp(1);
+  }
+  if (!(settings.outDir.isEmpty()) && !(QDir{}.mkpath(settings.outDir)))
+  {
+    printMessage("Can't create " + settings.outDir);
+    return 1;
+  }
+
+  // collect the jobs
+  QStringList jobFiles;
+  QFileInfo input{parser.positionalArguments().first()};
+  if (input.isDir())
+  {
+    QDir dir{input.absoluteFilePath()};
+    for (const QString& fn : dir.entryList(QStringList{"*.json"}, QDir::Files, QDir::Name))
+    {
+      jobFiles.append(dir.absoluteFilePath(fn));
+    }
+  } else {
+    jobFiles.append(input.absoluteFilePath());
+  }
+  if (jobFiles.isEmpty())
+  {
+    printMessage("No jobs found");
+    return 1;
+  }
+
+  // each thread takes the next job until all jobs are done; if there
+  // are several jobs, the image export of each job uses two threads
+  // (the minimum: one renderer and one encoder), so a job runs on up
+  // to three threads in total. A single job uses all cores for
+  // the image export (see PageImageExporter::exportAll())
+  int nThreads = parser.value(jobsOption).toInt();
+  if (nThreads <= 0) nThreads = std::max<int>(1, std::thread::hardware_concurrency());
+  nThreads = std::min(nThreads, jobFiles.size());
+  const int nExportThreads = (nThreads > 1) ? 2 : 0;
+
+  std::atomic<int> nextJob{0};
+  std::atomic<int> failedJobs{0};
+  auto worker = [&]() {
+    while (true)
+    {
+      int idx = nextJob++;
+      if (idx >= jobFiles.size()) return;
+      if (!(runJob(jobFiles.at(idx), settings, nExportThreads))) ++failedJobs;
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (int i = 1; i < nThreads; ++i) threads.emplace_back(worker);
+  worker();   // the main thread works, too
+  for (std::thread& t : threads) t.join();
+
+  return (failedJobs > 0) ? 1 : 0;
+}
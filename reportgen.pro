@@ -0,0 +1,39 @@
+#-------------------------------------------------
+#
+# Command line tool that renders JSON report
+# descriptions into PDF files or PNG images;
+# links against the core library
+#
+#-------------------------------------------------
+
+QT       += widgets svg
+
+TARGET = reportgen
+
+TEMPLATE = app
+
+CONFIG += c++14 console
+CONFIG -= app_bundle
+
+# the core library is built into the same directory
+win32:CONFIG(debug, debug|release): LIBS += -L$$OUT_PWD/debug
+win32:CONFIG(release, debug|release): LIBS += -L$$OUT_PWD/release
+LIBS += -L$$OUT_PWD
+
+CONFIG(debug, debug|release) {
+  LIBS += -lSimpleReportGeneratord
+} else {
+  LIBS += -lSimpleReportGenerator
+}
+
+SOURCES += reportgen.cpp
+
+unix {
+    target.path = /usr/local/bin
+}
+
+!unix {
+    target.path = D:/msys64/usr/local/bin
+}
+
+INSTALLS += target
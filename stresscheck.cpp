@@ -0,0 +1,308 @@
+/*
+ *    This is SimpleReportGenerator, a very basic report generator on top of Qt.
+ *    Copyright (C) 2014 - 2015  Volker Knollmann
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * stresscheck: lays out and exports reports from several threads at once
+ * and compares the results with a single-threaded reference run.
+ *
+ * All reports share a master page (text, line and SVG) and measure text
+ * with alternating fonts, so the check covers the shared master page
+ * pictures, the per-thread SVG renderers and the per-thread font caches.
+ *
+ * Usage:
+ *   stresscheck [nRounds]
+ *
+ * Returns 0 if all reports match the reference and 1 otherwise.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <QApplication>
+#include <QCryptographicHash>
+#include <QDir>
+#include <QImage>
+#include <QTemporaryDir>
+
+#include "SimpleReportGenerator.h"
+#include "JsonReportBuilder.h"
+#include "HeatmapChart.h"
+#include "ReportBatchRunner.h"
+
+using namespace SimpleReportLib;
+
+namespace {
+
+  constexpr int N_DISTINCT_RECORDS = 8;
+  constexpr int N_REPETITIONS = 12;
+  constexpr int N_LINES_PER_RECORD = 80;
+  constexpr int CHECK_DPI = 50;
+
+  const std::string LOGO_SVG{
+    "<svg xmlns='http://www.w3.org/2000/svg' width='40' height='20'>"
+    "<rect x='1' y='1' width='38' height='18' fill='#3b4cc0'/>"
+    "<circle cx='20' cy='10' r='6' fill='#b40426'/>"
+    "<text x='3' y='17' font-size='5'>SRG</text>"
+    "</svg>"
+  };
+
+  // the result of one report, compared against the reference
+  struct RecordResult
+  {
+    std::vector<QSizeF> textSizes;   // measured with getTextDimensions_MM()
+    std::vector<QByteArray> pageHashes;   // the hashes of the exported page images
+    bool hasError{false};
+  };
+
+  std::mutex consoleMutex;
+
+  //----------------------------------------------------------------------------
+
+  void printMessage(const QString& msg)
+  {
+    std::lock_guard<std::mutex> lock{consoleMutex};
+    fprintf(stderr, "%s\n", qPrintable(msg));
+  }
+
+  //----------------------------------------------------------------------------
+
+  std::unique_ptr<SimpleReportGenerator> createPrototype()
+  {
+    auto proto = std::make_unique<SimpleReportGenerator>(210, 297, 20);
+
+    // no date or time, because the results must be reproducible
+    proto->setGlobalHeader("Stress check", "", "Page $#$ of $##$");
+    proto->setGlobalFooter("", "SimpleReportGenerator", "");
+
+    proto->beginMasterPage();
+    proto->addSVG_byData_setW(QPointF{150, 3}, RECT_CORNER::TOP_LEFT, LOGO_SVG, 30);
+    proto->drawHorLine(20, 285, 170);
+    proto->drawText(20, 290, "Confidential");
+    proto->endMasterPage();
+
+    return proto;
+  }
+
+  //----------------------------------------------------------------------------
+
+  void buildReport(SimpleReportGenerator& report, int idxDistinctRecord, std::vector<QSizeF>& textSizes)
+  {
+    static const QString fonts[] = {"Arial", "Courier", "Times"};
+
+    report.startNextPage();
+
+    for (int i = 0; i < N_LINES_PER_RECORD; ++i)
+    {
+      QString txt = QString{"Record %1, line %2: the quick brown fox jumps over the lazy dog"}.arg(idxDistinctRecord).arg(i);
+      report.writeLine(txt);
+
+      // the fonts are cached per thread; alternate between them
+      // so that the cache is filled from all threads at once
+      textSizes.push_back(report.getTextDimensions_MM(txt, 2.0 + (i % 3), (i % 2) == 0, fonts[i % 3]));
+
+      if ((i % 25) == 0) JsonReportBuilder::writeSvg(report, LOGO_SVG, 20 + idxDistinctRecord, "right");
+    }
+
+    // a heatmap with invalid values
+    if (report.getRemainingPageHeight() < 70) report.startNextPage();
+    QPointF pos = report.getAbsCursorPos();
+    HeatmapChart heatmap{&report, pos.x(), pos.y(), 120, 60};
+    constexpr int nRows = 12;
+    constexpr int nCols = 24;
+    std::vector<double> values(nRows * nCols);
+    for (size_t k = 0; k < values.size(); ++k)
+    {
+      values[k] = sin(0.1 * k + idxDistinctRecord);
+    }
+    values[5] = std::numeric_limits<double>::quiet_NaN();
+    values[17] = std::numeric_limits<double>::infinity();
+    heatmap.setMatrix(std::move(values), nRows, nCols);
+    heatmap.render();
+    report.skip(65);
+
+    report.applyHeaderAndFooterOnAllPages();
+  }
+
+  //----------------------------------------------------------------------------
+
+  // exports all pages into a temporary directory and hashes the decoded images
+  bool hashPages(SimpleReportGenerator& report, int nThreads, std::vector<QByteArray>& pageHashes)
+  {
+    QTemporaryDir tmpDir;
+    if (!tmpDir.isValid()) return false;
+
+    ImageExportStats stats = report.exportPagesAsImages(tmpDir.path(), CHECK_DPI, "PNG", nThreads);
+    if ((stats.failedPages > 0) || (stats.exportedPages == 0)) return false;
+
+    pageHashes.clear();
+    for (int idxPage = 0; idxPage < stats.exportedPages; ++idxPage)
+    {
+      QString fName = QDir{tmpDir.path()}.filePath(PageImageExporter::pageFileName(idxPage, stats.exportedPages, "PNG"));
+      QImage img{fName};
+      if (img.isNull()) return false;
+      img = img.convertToFormat(QImage::Format_ARGB32);
+
+      QCryptographicHash hash{QCryptographicHash::Sha1};
+      hash.addData(reinterpret_cast<const char*>(img.constBits()), static_cast<int>(img.sizeInBytes()));
+      pageHashes.push_back(hash.result());
+    }
+
+    return true;
+  }
+
+  //----------------------------------------------------------------------------
+
+  // returns a description of the first difference or an empty string
+  QString compareResults(const RecordResult& ref, const RecordResult& res)
+  {
+    if (res.hasError) return "layout or export failed";
+
+    if (res.textSizes.size() != ref.textSizes.size()) return "different number of text measurements";
+    for (size_t i = 0; i < ref.textSizes.size(); ++i)
+    {
+      if (res.textSizes[i] != ref.textSizes[i]) return QString{"different text size in line %1"}.arg(i);
+    }
+
+    if (res.pageHashes.size() != ref.pageHashes.size()) return "different number of pages";
+    for (size_t i = 0; i < ref.pageHashes.size(); ++i)
+    {
+      if (res.pageHashes[i] != ref.pageHashes[i]) return QString{"page %1 differs"}.arg(i + 1);
+    }
+
+    return QString{};
+  }
+
+  //----------------------------------------------------------------------------
+
+  // lays out and exports reports on all cores; each worker renders its own reports
+  int checkBatch(const SimpleReportGenerator& proto, const std::vector<RecordResult>& reference)
+  {
+    int nRecords = N_DISTINCT_RECORDS * N_REPETITIONS;
+    QVariantList records;
+    for (int i = 0; i < nRecords; ++i) records.append(i);
+
+    std::vector<RecordResult> results(nRecords);   // each entry is only touched by one worker
+
+    ReportBatchRunner runner{210, 297, 20};
+    runner.setPrototype(&proto);
+    BatchRunStats stats = runner.run(records,
+                                     [&results](SimpleReportGenerator& report, const QVariant& record)
+    {
+      int idx = record.toInt();
+      buildReport(report, idx % N_DISTINCT_RECORDS, results[idx].textSizes);
+    },
+    [&results](std::unique_ptr<SimpleReportGenerator> report, int idxRecord)
+    {
+      // export right here on the worker thread, concurrently with the other workers
+      RecordResult& res = results[idxRecord];
+      res.hasError = !hashPages(*report, 2, res.pageHashes);
+    });
+
+    int nMismatches = stats.failedReports;
+    for (int i = 0; i < nRecords; ++i)
+    {
+      QString diff = (results[i].pageHashes.empty() && !results[i].hasError) ? QString{"report not finished"}
+                                                                              : compareResults(reference[i % N_DISTINCT_RECORDS], results[i]);
+      if (diff.isEmpty()) continue;
+      printMessage(QString{"Batch: record %1: %2"}.arg(i).arg(diff));
+      ++nMismatches;
+    }
+
+    printMessage(QString{"Batch: %1 reports, %2 failed, %3 reports/s"}
+                 .arg(stats.finishedReports).arg(nMismatches).arg(stats.reportsPerSecond, 0, 'f', 1));
+
+    return nMismatches;
+  }
+
+  //----------------------------------------------------------------------------
+
+  // renders the pages of a single report on several threads at once
+  int checkParallelExport(const SimpleReportGenerator& proto, const std::vector<RecordResult>& reference)
+  {
+    int nThreads = std::max<int>(4, 2 * std::thread::hardware_concurrency());
+    int nMismatches = 0;
+
+    for (int idx = 0; idx < N_DISTINCT_RECORDS; ++idx)
+    {
+      auto report = proto.cloneConfiguration();
+      RecordResult res;
+      buildReport(*report, idx, res.textSizes);
+      res.hasError = !hashPages(*report, nThreads, res.pageHashes);
+
+      QString diff = compareResults(reference[idx], res);
+      if (diff.isEmpty()) continue;
+      printMessage(QString{"Parallel export: record %1: %2"}.arg(idx).arg(diff));
+      ++nMismatches;
+    }
+
+    return nMismatches;
+  }
+
+}
+
+//----------------------------------------------------------------------------
+
+int main(int argc, char *argv[])
+{
+  // the scenes need a QApplication, but no display
+  if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) qputenv("QT_QPA_PLATFORM", "offscreen");
+
+  QApplication app{argc, argv};
+  QApplication::setApplicationName("stresscheck");
+
+  int nRounds = (argc > 1) ? std::max(1, atoi(argv[1])) : 3;
+
+  auto proto = createPrototype();
+
+  // the single-threaded reference; all image exports use a
+  // single render thread here
+  std::vector<RecordResult> reference(N_DISTINCT_RECORDS);
+  for (int idx = 0; idx < N_DISTINCT_RECORDS; ++idx)
+  {
+    auto report = proto->cloneConfiguration();
+    buildReport(*report, idx, reference[idx].textSizes);
+    if (!hashPages(*report, 2, reference[idx].pageHashes))
+    {
+      printMessage(QString{"Reference: record %1 could not be exported"}.arg(idx));
+      return 1;
+    }
+  }
+
+  int nMismatches = 0;
+  for (int round = 0; round < nRounds; ++round)
+  {
+    printMessage(QString{"Round %1 of %2"}.arg(round + 1).arg(nRounds));
+    nMismatches += checkBatch(*proto, reference);
+    nMismatches += checkParallelExport(*proto, reference);
+  }
+
+  if (nMismatches > 0)
+  {
+    printMessage(QString{"FAILED: %1 mismatches"}.arg(nMismatches));
+    return 1;
+  }
+
+  printMessage("OK");
+  return 0;
+}
@@ -0,0 +1,29 @@
+#-------------------------------------------------
+#
+# Stand-alone check that lays out and exports
+# reports from several threads at once;
+# links against the core library
+#
+#-------------------------------------------------
+
+QT       += widgets svg
+
+TARGET = stresscheck
+
+TEMPLATE = app
+
+CONFIG += c++14 console
+CONFIG -= app_bundle
+
+# the core library is built into the same directory
+win32:CONFIG(debug, debug|release): LIBS += -L$$OUT_PWD/debug
+win32:CONFIG(release, debug|release): LIBS += -L$$OUT_PWD/release
+LIBS += -L$$OUT_PWD
+
+CONFIG(debug, debug|release) {
+  LIBS += -lSimpleReportGeneratord
+} else {
+  LIBS += -lSimpleReportGenerator
+}
+
+SOURCES += stresscheck.cpp